@@ -0,0 +1,32 @@
+import '../models/blinky_effect.dart';
+import 'mock_data.dart';
+import 'native_effects_stub.dart'
+    if (dart.library.ffi) 'native_effects_ffi.dart';
+
+/// Every effect the app offers, indexed by engine effect ID.
+///
+/// Where the native engine is available the list comes from its effect
+/// registry, so the IDs stored in [LightingState] are the ones the renderer
+/// dispatches on. Otherwise it falls back to [kMockEffects], which uses the
+/// same IDs.
+final List<BlinkyEffect> kEffects = _loadEffects();
+
+/// Returns the effect with engine ID [id].
+BlinkyEffect effectById(int id) => kEffects[id];
+
+List<BlinkyEffect> _loadEffects() {
+  final native = loadNativeEffects();
+  if (native == null) return kMockEffects;
+  return [
+    for (final effect in native)
+      BlinkyEffect(
+        id: effect.id,
+        name: effect.name,
+        // Icons are presentation only and stay on the Dart side.
+        icon: effect.id < kMockEffects.length
+            ? kMockEffects[effect.id].icon
+            : '✨',
+        category: effect.category,
+      ),
+  ];
+}
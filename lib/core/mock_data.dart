@@ -1,22 +1,25 @@
 import '../models/blinky_effect.dart';
 
+// Ordered by engine effect ID (see linux/engine/effect_registry.h).
 const List<BlinkyEffect> kMockEffects = [
-  BlinkyEffect(name: 'Rainbow Swirl', icon: '🌈', category: 'Animated'),
-  BlinkyEffect(name: 'Color Mood Blobs', icon: '🫧', category: 'Animated'),
-  BlinkyEffect(name: 'Police Lights', icon: '🚔', category: 'Party'),
-  BlinkyEffect(name: 'Strobe White', icon: '⚡', category: 'Party'),
-  BlinkyEffect(name: 'Fire', icon: '🔥', category: 'Animated'),
-  BlinkyEffect(name: 'Ocean Waves', icon: '🌊', category: 'Animated'),
-  BlinkyEffect(name: 'Pulsing Purple', icon: '💜', category: 'Animated'),
-  BlinkyEffect(name: 'Twinkle', icon: '✨', category: 'Static'),
-  BlinkyEffect(name: 'Warm Sunset', icon: '🌅', category: 'Static'),
-  BlinkyEffect(name: 'Ice Blue', icon: '🧊', category: 'Static'),
-  BlinkyEffect(name: 'Forest Green', icon: '🌿', category: 'Static'),
-  BlinkyEffect(name: 'Candy Cane', icon: '🍬', category: 'Party'),
-  BlinkyEffect(name: 'Matrix Rain', icon: '💻', category: 'Animated'),
-  BlinkyEffect(name: 'Heartbeat', icon: '❤️', category: 'Animated'),
-  BlinkyEffect(name: 'Northern Lights', icon: '🌌', category: 'Animated'),
-  BlinkyEffect(name: 'Lava Lamp', icon: '🫙', category: 'Animated'),
+  BlinkyEffect(id: 0, name: 'Rainbow Swirl', icon: '🌈', category: 'Animated'),
+  BlinkyEffect(
+      id: 1, name: 'Color Mood Blobs', icon: '🫧', category: 'Animated'),
+  BlinkyEffect(id: 2, name: 'Police Lights', icon: '🚔', category: 'Party'),
+  BlinkyEffect(id: 3, name: 'Strobe White', icon: '⚡', category: 'Party'),
+  BlinkyEffect(id: 4, name: 'Fire', icon: '🔥', category: 'Animated'),
+  BlinkyEffect(id: 5, name: 'Ocean Waves', icon: '🌊', category: 'Animated'),
+  BlinkyEffect(id: 6, name: 'Pulsing Purple', icon: '💜', category: 'Animated'),
+  BlinkyEffect(id: 7, name: 'Twinkle', icon: '✨', category: 'Static'),
+  BlinkyEffect(id: 8, name: 'Warm Sunset', icon: '🌅', category: 'Static'),
+  BlinkyEffect(id: 9, name: 'Ice Blue', icon: '🧊', category: 'Static'),
+  BlinkyEffect(id: 10, name: 'Forest Green', icon: '🌿', category: 'Static'),
+  BlinkyEffect(id: 11, name: 'Candy Cane', icon: '🍬', category: 'Party'),
+  BlinkyEffect(id: 12, name: 'Matrix Rain', icon: '💻', category: 'Animated'),
+  BlinkyEffect(id: 13, name: 'Heartbeat', icon: '❤️', category: 'Animated'),
+  BlinkyEffect(
+      id: 14, name: 'Northern Lights', icon: '🌌', category: 'Animated'),
+  BlinkyEffect(id: 15, name: 'Lava Lamp', icon: '🫙', category: 'Animated'),
 ];
 
 const List<String> kCategories = ['All', 'Animated', 'Static', 'Party'];
@@ -0,0 +1,54 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+
+import '../models/blinky_effect.dart';
+
+// Bindings for linux/engine/engine_ffi.h.
+typedef _CountNative = Uint32 Function();
+typedef _Count = int Function();
+typedef _NameNative = Pointer<Uint8> Function(Uint32 id);
+typedef _Name = Pointer<Uint8> Function(int id);
+typedef _CategoryNative = Uint32 Function(Uint32 id);
+typedef _Category = int Function(int id);
+
+/// Category names in the order of the engine's EffectCategory enum.
+const List<String> _kCategories = ['Animated', 'Static', 'Party'];
+
+/// Reads the effect registry from the native engine, or returns null if the
+/// engine library isn't bundled on this platform. Icons are left empty.
+List<BlinkyEffect>? loadNativeEffects() {
+  if (!Platform.isLinux) return null;
+
+  final DynamicLibrary library;
+  try {
+    library = DynamicLibrary.open('libblinky_engine_ffi.so');
+  } on ArgumentError {
+    return null;
+  }
+
+  final count =
+      library.lookupFunction<_CountNative, _Count>('blinky_effect_count');
+  final name =
+      library.lookupFunction<_NameNative, _Name>('blinky_effect_name');
+  final category = library
+      .lookupFunction<_CategoryNative, _Category>('blinky_effect_category');
+
+  return [
+    for (var id = 0; id < count(); id++)
+      BlinkyEffect(
+        id: id,
+        name: _readCString(name(id)),
+        icon: '',
+        category: _kCategories[category(id)],
+      ),
+  ];
+}
+
+String _readCString(Pointer<Uint8> pointer) {
+  var length = 0;
+  while (pointer[length] != 0) {
+    length++;
+  }
+  return utf8.decode(pointer.asTypedList(length));
+}
@@ -0,0 +1,4 @@
+import '../models/blinky_effect.dart';
+
+/// Platforms without dart:ffi have no native engine.
+List<BlinkyEffect>? loadNativeEffects() => null;
@@ -0,0 +1,145 @@
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+
+// Client for the packed pixel protocol served by linux/pixel_channel.cc.
+// The format is defined in linux/engine/pixel_protocol.h; keep the two in
+// sync.
+const int _kMagic = 0x4B4E4C42; // "BLNK"
+const int _kVersion = 1;
+const int _kRequestHeaderSize = 16;
+const int _kResponseHeaderSize = 32;
+
+const int _kGetFrame = 1;
+const int _kGetStats = 2;
+const int _kSetPixels = 3;
+
+/// Bytes per pixel: premultiplied RGBA.
+const int kPixelBytes = 4;
+
+/// A range of pixels from the engine's latest frame.
+class PixelFrame {
+  final int width;
+  final int height;
+  final int frameIndex;
+
+  /// Premultiplied RGBA bytes. A view into the response message, not a copy.
+  final Uint8List rgba;
+
+  const PixelFrame({
+    required this.width,
+    required this.height,
+    required this.frameIndex,
+    required this.rgba,
+  });
+}
+
+class PixelStats {
+  final int framesRendered;
+  final int framesDropped;
+  final int arenaHighWater;
+  final int heapAllocations;
+
+  const PixelStats({
+    required this.framesRendered,
+    required this.framesDropped,
+    required this.arenaHighWater,
+    required this.heapAllocations,
+  });
+}
+
+class PixelChannelException implements Exception {
+  final String message;
+
+  const PixelChannelException(this.message);
+
+  @override
+  String toString() => 'PixelChannelException: $message';
+}
+
+/// Bulk pixel transfer with the native engine.
+///
+/// Messages are packed binary rather than standard-codec values, so
+/// 100k-pixel frames cross the channel without boxing each color.
+class PixelChannel {
+  static const BasicMessageChannel<ByteData?> _channel =
+      BasicMessageChannel<ByteData?>('blinky/pixels', BinaryCodec());
+
+  /// Reads [count] pixels starting at [first] from the latest frame, or the
+  /// whole frame if [count] is null.
+  static Future<PixelFrame> fetchFrame({int first = 0, int? count}) async {
+    if (count == null) {
+      // The header of any response carries the layout size.
+      final stats = await _send(_request(_kGetStats, 0, 0));
+      count = stats.getUint32(8, Endian.little) *
+              stats.getUint32(12, Endian.little) -
+          first;
+    }
+    final response = await _send(_request(_kGetFrame, first, count));
+    return PixelFrame(
+      width: response.getUint32(8, Endian.little),
+      height: response.getUint32(12, Endian.little),
+      frameIndex: response.getUint64(16, Endian.little),
+      rgba: response.buffer.asUint8List(
+        response.offsetInBytes + _kResponseHeaderSize,
+        response.getUint32(24, Endian.little) * kPixelBytes,
+      ),
+    );
+  }
+
+  static Future<PixelStats> fetchStats() async {
+    final response = await _send(_request(_kGetStats, 0, 0));
+    int field(int index) =>
+        response.getUint64(_kResponseHeaderSize + index * 8, Endian.little);
+    return PixelStats(
+      framesRendered: field(0),
+      framesDropped: field(1),
+      arenaHighWater: field(2),
+      heapAllocations: field(3),
+    );
+  }
+
+  /// Replaces zone colors starting at pixel [first] with premultiplied RGBA
+  /// bytes. They are composited over the running effect from the next
+  /// frame.
+  static Future<void> uploadPixels(int first, Uint8List rgba) async {
+    if (rgba.length % kPixelBytes != 0) {
+      throw ArgumentError.value(rgba.length, 'rgba', 'not whole pixels');
+    }
+    final count = rgba.length ~/ kPixelBytes;
+    final request = _request(_kSetPixels, first, count, payload: rgba.length);
+    request.buffer.asUint8List(_kRequestHeaderSize).setAll(0, rgba);
+    await _send(request);
+  }
+
+  static ByteData _request(int type, int first, int count, {int payload = 0}) {
+    return ByteData(_kRequestHeaderSize + payload)
+      ..setUint32(0, _kMagic, Endian.little)
+      ..setUint16(4, _kVersion, Endian.little)
+      ..setUint16(6, type, Endian.little)
+      ..setUint32(8, first, Endian.little)
+      ..setUint32(12, count, Endian.little);
+  }
+
+  static Future<ByteData> _send(ByteData request) async {
+    final response = await _channel.send(request);
+    if (response == null) {
+      throw const PixelChannelException('no pixel channel on this platform');
+    }
+    if (response.lengthInBytes < _kResponseHeaderSize ||
+        response.getUint32(0, Endian.little) != _kMagic) {
+      throw const PixelChannelException('malformed response');
+    }
+    final status = response.getUint16(6, Endian.little);
+    if (status != 0) {
+      throw PixelChannelException(_kStatusMessages[status] ?? 'status $status');
+    }
+    return response;
+  }
+
+  static const Map<int, String> _kStatusMessages = {
+    1: 'bad request',
+    2: 'pixel range outside the layout',
+    3: 'no frame rendered yet',
+  };
+}
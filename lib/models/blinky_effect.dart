@@ -1,9 +1,12 @@
 class BlinkyEffect {
+  /// Engine effect ID; the effect's index in the native effect registry.
+  final int id;
   final String name;
   final String icon;
   final String category;
 
   const BlinkyEffect({
+    required this.id,
     required this.name,
     required this.icon,
     required this.category,
@@ -4,25 +4,26 @@ import 'package:flutter_riverpod/flutter_riverpod.dart';
 class LightingState {
   final Color color;
   final double brightness;
-  final String? activeEffect;
+  /// Engine ID of the running effect, or null for a solid color.
+  final int? activeEffectId;
 
   const LightingState({
     required this.color,
     required this.brightness,
-    this.activeEffect,
+    this.activeEffectId,
   });
 
   LightingState copyWith({
     Color? color,
     double? brightness,
-    Object? activeEffect = _sentinel,
+    Object? activeEffectId = _sentinel,
   }) {
     return LightingState(
       color: color ?? this.color,
       brightness: brightness ?? this.brightness,
-      activeEffect: activeEffect == _sentinel
-          ? this.activeEffect
-          : activeEffect as String?,
+      activeEffectId: activeEffectId == _sentinel
+          ? this.activeEffectId
+          : activeEffectId as int?,
     );
   }
 
@@ -45,24 +46,24 @@ class LightingNotifier extends Notifier<LightingState> {
     return const LightingState(
       color: Color(0xFF7C6BFF),
       brightness: 1.0,
-      activeEffect: null,
+      activeEffectId: null,
     );
   }
 
   void setColor(Color color) {
-    state = state.copyWith(color: color, activeEffect: null);
+    state = state.copyWith(color: color, activeEffectId: null);
   }
 
   void setBrightness(double value) {
     state = state.copyWith(brightness: value.clamp(0.0, 1.0));
   }
 
-  void activateEffect(String name) {
-    state = state.copyWith(activeEffect: name);
+  void activateEffect(int id) {
+    state = state.copyWith(activeEffectId: id);
   }
 
   void clearEffect() {
-    state = state.copyWith(activeEffect: null);
+    state = state.copyWith(activeEffectId: null);
   }
 }
 
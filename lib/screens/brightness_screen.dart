@@ -1,6 +1,7 @@
 import 'package:flutter/material.dart';
 import 'package:flutter_riverpod/flutter_riverpod.dart';
 
+import '../core/effect_registry.dart';
 import '../providers/lighting_provider.dart';
 import '../widgets/brightness_preview.dart';
 
@@ -107,7 +108,7 @@ class BrightnessScreen extends ConsumerWidget {
             ],
           ),
 
-          if (state.activeEffect != null) ...[
+          if (state.activeEffectId != null) ...[
             const SizedBox(height: 28),
             Container(
               padding: const EdgeInsets.symmetric(horizontal: 16, vertical: 12),
@@ -121,7 +122,7 @@ class BrightnessScreen extends ConsumerWidget {
                   Icon(Icons.auto_awesome, size: 16, color: primary),
                   const SizedBox(width: 8),
                   Text(
-                    state.activeEffect!,
+                    effectById(state.activeEffectId!).name,
                     style: TextStyle(
                       fontSize: 13,
                       color: primary,
@@ -2,6 +2,7 @@ import 'package:flutter/material.dart';
 import 'package:flutter_colorpicker/flutter_colorpicker.dart';
 import 'package:flutter_riverpod/flutter_riverpod.dart';
 
+import '../core/effect_registry.dart';
 import '../providers/lighting_provider.dart';
 import '../widgets/hex_input_field.dart';
 
@@ -67,9 +68,9 @@ class ColorScreen extends ConsumerWidget {
           const SizedBox(height: 20),
 
           // Active effect badge
-          if (state.activeEffect != null)
+          if (state.activeEffectId != null)
             _ActiveEffectBadge(
-              effectName: state.activeEffect!,
+              effectName: effectById(state.activeEffectId!).name,
               onClear: notifier.clearEffect,
             ),
         ],
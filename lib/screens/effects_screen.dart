@@ -1,6 +1,7 @@
 import 'package:flutter/material.dart';
 import 'package:flutter_riverpod/flutter_riverpod.dart';
 
+import '../core/effect_registry.dart';
 import '../core/mock_data.dart';
 import '../models/blinky_effect.dart';
 import '../providers/lighting_provider.dart';
@@ -17,8 +18,8 @@ class _EffectsScreenState extends ConsumerState<EffectsScreen> {
   String _selectedCategory = 'All';
 
   List<BlinkyEffect> get _filtered {
-    if (_selectedCategory == 'All') return kMockEffects;
-    return kMockEffects
+    if (_selectedCategory == 'All') return kEffects;
+    return kEffects
         .where((e) => e.category == _selectedCategory)
         .toList();
   }
@@ -42,7 +43,7 @@ class _EffectsScreenState extends ConsumerState<EffectsScreen> {
                 ),
                 const SizedBox(height: 4),
                 Text(
-                  '${kMockEffects.length} effects available',
+                  '${kEffects.length} effects available',
                   style: Theme.of(context).textTheme.bodySmall,
                 ),
                 const SizedBox(height: 16),
@@ -83,7 +84,7 @@ class _EffectsScreenState extends ConsumerState<EffectsScreen> {
             itemCount: _filtered.length,
             itemBuilder: (context, i) {
               final effect = _filtered[i];
-              final isActive = state.activeEffect == effect.name;
+              final isActive = state.activeEffectId == effect.id;
               return EffectCard(
                 name: effect.name,
                 icon: effect.icon,
@@ -93,7 +94,7 @@ class _EffectsScreenState extends ConsumerState<EffectsScreen> {
                   if (isActive) {
                     notifier.clearEffect();
                   } else {
-                    notifier.activateEffect(effect.name);
+                    notifier.activateEffect(effect.id);
                   }
                 },
               );
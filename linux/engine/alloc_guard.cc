@@ -0,0 +1,123 @@
+#include "engine/alloc_guard.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+namespace blinky {
+
+namespace {
+
+thread_local int t_guard_depth = 0;
+thread_local size_t t_guarded_allocations = 0;
+
+}  // namespace
+
+#ifdef BLINKY_ENGINE_ALLOC_GUARD
+
+namespace {
+
+void NoteAllocation() {
+  if (t_guard_depth > 0) ++t_guarded_allocations;
+}
+
+void* CountedAlloc(std::size_t size) {
+  NoteAllocation();
+  if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+  throw std::bad_alloc();
+}
+
+void* CountedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+  NoteAllocation();
+  const std::size_t align = static_cast<std::size_t>(alignment);
+  // aligned_alloc requires the size to be a multiple of the alignment.
+  const std::size_t rounded =
+      ((size == 0 ? 1 : size) + align - 1) & ~(align - 1);
+  if (void* p = std::aligned_alloc(align, rounded)) return p;
+  throw std::bad_alloc();
+}
+
+}  // namespace
+
+bool AllocationGuardEnabled() {
+  return true;
+}
+
+#else
+
+bool AllocationGuardEnabled() {
+  return false;
+}
+
+#endif  // BLINKY_ENGINE_ALLOC_GUARD
+
+ScopedNoHeapAllocation::ScopedNoHeapAllocation(bool assert_on_exit)
+    : thread_count_at_entry_(t_guarded_allocations),
+      assert_on_exit_(assert_on_exit) {
+  ++t_guard_depth;
+}
+
+ScopedNoHeapAllocation::~ScopedNoHeapAllocation() {
+  --t_guard_depth;
+  assert((!assert_on_exit_ || allocations() == 0) &&
+         "heap allocation inside the frame loop");
+}
+
+size_t ScopedNoHeapAllocation::allocations() const {
+  return t_guarded_allocations - thread_count_at_entry_;
+}
+
+}  // namespace blinky
+
+#ifdef BLINKY_ENGINE_ALLOC_GUARD
+
+// The remaining forms of operator new and delete forward to these.
+void* operator new(std::size_t size) {
+  return blinky::CountedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+  return blinky::CountedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return blinky::CountedAlignedAlloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return blinky::CountedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+#endif  // BLINKY_ENGINE_ALLOC_GUARD
@@ -0,0 +1,40 @@
+#ifndef BLINKY_ENGINE_ALLOC_GUARD_H_
+#define BLINKY_ENGINE_ALLOC_GUARD_H_
+
+#include <cstddef>
+
+namespace blinky {
+
+// Heap allocation tracking for the frame loop.
+//
+// When the engine is built with BLINKY_ENGINE_ALLOC_GUARD defined (Debug
+// builds and the standalone test build), the global operator new is replaced
+// with one that counts, per thread, the allocations a thread makes while it
+// is inside a ScopedNoHeapAllocation. Otherwise the guard compiles to
+// nothing and the counts stay at zero.
+
+// Returns true if allocation counting is compiled in.
+bool AllocationGuardEnabled();
+
+// Marks the calling thread as being inside the frame loop for the lifetime
+// of the object. Scopes nest. Unless |assert_on_exit| is false, debug builds
+// assert on destruction that the scope made no heap allocations.
+class ScopedNoHeapAllocation {
+ public:
+  explicit ScopedNoHeapAllocation(bool assert_on_exit = true);
+  ~ScopedNoHeapAllocation();
+
+  ScopedNoHeapAllocation(const ScopedNoHeapAllocation&) = delete;
+  ScopedNoHeapAllocation& operator=(const ScopedNoHeapAllocation&) = delete;
+
+  // Allocations made by this thread since the scope was entered.
+  size_t allocations() const;
+
+ private:
+  size_t thread_count_at_entry_;
+  bool assert_on_exit_;
+};
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_ALLOC_GUARD_H_
@@ -0,0 +1,43 @@
+#include "engine/buffer_pool.h"
+
+#include <cassert>
+
+namespace blinky {
+
+BufferPool::BufferPool(size_t buffer_size, size_t buffer_count)
+    : buffer_size_(buffer_size),
+      stride_((buffer_size + kAlignment - 1) & ~(kAlignment - 1)),
+      buffer_count_(buffer_count),
+      storage_(new uint8_t[stride_ * buffer_count + kAlignment]) {
+  const uintptr_t base = reinterpret_cast<uintptr_t>(storage_.get());
+  first_ = storage_.get() + ((kAlignment - base % kAlignment) % kAlignment);
+  free_.reserve(buffer_count);
+  // Hand out the lowest addresses first.
+  for (size_t i = buffer_count; i > 0; --i) {
+    free_.push_back(first_ + (i - 1) * stride_);
+  }
+}
+
+uint8_t* BufferPool::Acquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (free_.empty()) return nullptr;
+  uint8_t* buffer = free_.back();
+  free_.pop_back();
+  return buffer;
+}
+
+void BufferPool::Release(uint8_t* buffer) {
+  assert(buffer >= first_ && buffer < first_ + stride_ * buffer_count_);
+  assert((buffer - first_) % stride_ == 0);
+  std::lock_guard<std::mutex> lock(mutex_);
+  assert(free_.size() < buffer_count_);
+  // Capacity was reserved for every buffer, so this never reallocates.
+  free_.push_back(buffer);
+}
+
+size_t BufferPool::available() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return free_.size();
+}
+
+}  // namespace blinky
@@ -0,0 +1,52 @@
+#ifndef BLINKY_ENGINE_BUFFER_POOL_H_
+#define BLINKY_ENGINE_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace blinky {
+
+// A fixed set of equally sized byte buffers carved from one allocation.
+// Acquire() and Release() only move pointers on a preallocated free list, so
+// frames and packets can cycle between the render and output threads
+// without heap traffic.
+class BufferPool {
+ public:
+  // Buffers are aligned to 64 bytes so they never share a cache line.
+  static constexpr size_t kAlignment = 64;
+
+  BufferPool(size_t buffer_size, size_t buffer_count);
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  // Returns a free buffer, or null if all are in use.
+  uint8_t* Acquire();
+
+  // Returns |buffer|, which must have come from Acquire(), to the pool.
+  void Release(uint8_t* buffer);
+
+  size_t buffer_size() const { return buffer_size_; }
+  size_t buffer_count() const { return buffer_count_; }
+  size_t available() const;
+
+  // The contiguous block every buffer is carved from.
+  const uint8_t* data() const { return first_; }
+  size_t data_size() const { return stride_ * buffer_count_; }
+
+ private:
+  size_t buffer_size_;
+  size_t stride_;
+  size_t buffer_count_;
+  std::unique_ptr<uint8_t[]> storage_;
+  uint8_t* first_;
+  mutable std::mutex mutex_;
+  std::vector<uint8_t*> free_;
+};
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_BUFFER_POOL_H_
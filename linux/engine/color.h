@@ -0,0 +1,54 @@
+#ifndef BLINKY_ENGINE_COLOR_H_
+#define BLINKY_ENGINE_COLOR_H_
+
+#include <cstdint>
+#include <string_view>
+
+namespace blinky {
+
+// An 8-bit RGBA color. Engine buffers always hold alpha premultiplied into
+// the color channels, so layers composite with a single multiply-add.
+struct Rgba8 {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+  uint8_t a;
+};
+
+inline bool operator==(Rgba8 lhs, Rgba8 rhs) {
+  return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+}
+
+inline bool operator!=(Rgba8 lhs, Rgba8 rhs) {
+  return !(lhs == rhs);
+}
+
+// Returns |value| * |scale| / 255, rounded to nearest.
+inline uint8_t Scale8(uint8_t value, uint8_t scale) {
+  const uint32_t product = uint32_t{value} * scale + 128;
+  return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+}
+
+// Returns the blend of |from| and |to|, where |amount| 0 is all |from| and
+// 255 is all |to|, rounded to nearest.
+inline uint8_t Lerp8(uint8_t from, uint8_t to, uint8_t amount) {
+  return static_cast<uint8_t>(
+      (uint32_t{from} * (255 - amount) + uint32_t{to} * amount + 127) / 255);
+}
+
+// Returns the premultiplied form of the opaque color |rgb| (0xRRGGBB) at
+// opacity |alpha|.
+inline Rgba8 Premultiply(uint32_t rgb, uint8_t alpha) {
+  return Rgba8{Scale8(static_cast<uint8_t>(rgb >> 16), alpha),
+               Scale8(static_cast<uint8_t>(rgb >> 8), alpha),
+               Scale8(static_cast<uint8_t>(rgb), alpha), alpha};
+}
+
+// Parses a color written the way the app's HexInputField accepts it:
+// "#RRGGBB", case-insensitive, with the '#' optional and surrounding
+// whitespace ignored. Stores 0xRRGGBB in |rgb| and returns true on success.
+bool ParseHexColor(std::string_view text, uint32_t* rgb);
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_COLOR_H_
@@ -0,0 +1,117 @@
+#ifndef BLINKY_ENGINE_EFFECT_H_
+#define BLINKY_ENGINE_EFFECT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/frame_arena.h"
+#include "engine/palette.h"
+
+namespace blinky {
+
+// The physical arrangement of pixels, addressed row-major from the top left.
+struct Layout {
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  size_t pixel_count() const { return size_t{width} * height; }
+};
+
+constexpr size_t kMaxLayerParams = 4;
+
+// Frames are rendered in tiles: fixed runs of consecutive pixels small
+// enough that a tile of RGBA output plus effect state stays in L2. Tile
+// boundaries depend only on the layout, never on the thread count.
+constexpr size_t kTilePixels = 4096;
+
+struct Tile {
+  size_t index;
+  size_t begin;
+  size_t end;
+
+  size_t size() const { return end - begin; }
+};
+
+inline size_t TileCount(const Layout& layout) {
+  return (layout.pixel_count() + kTilePixels - 1) / kTilePixels;
+}
+
+inline Tile GetTile(const Layout& layout, size_t index) {
+  const size_t begin = index * kTilePixels;
+  const size_t count = layout.pixel_count();
+  return Tile{index, begin,
+              count - begin < kTilePixels ? count : begin + kTilePixels};
+}
+
+// The SplitMix64 finalizer: a cheap, well-mixed 64-bit hash.
+inline uint64_t SplitMix64(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+  return value ^ (value >> 31);
+}
+
+// A random stream private to one tile of one frame. Each tile draws from
+// its own stream in pixel order, so results are bit-identical however the
+// tiles are spread across threads.
+class TileRng {
+ public:
+  TileRng(uint64_t seed, uint64_t frame_index, size_t tile_index)
+      : state_(SplitMix64(seed ^
+                          SplitMix64(frame_index * kGolden + tile_index))) {}
+
+  uint32_t Next() {
+    state_ += kGolden;
+    return static_cast<uint32_t>(SplitMix64(state_) >> 32);
+  }
+
+ private:
+  static constexpr uint64_t kGolden = 0x9E3779B97F4A7C15ull;
+
+  uint64_t state_;
+};
+
+// What an effect sees for one frame.
+struct EffectContext {
+  const Layout* layout;
+  // Seconds on the pipeline clock.
+  double time;
+  uint64_t frame_index;
+  // The layer's palette, or null if it has none.
+  const PaletteLut* palette;
+  const float* params;
+  // Per-frame scratch memory. Only the prepare step may allocate from it;
+  // tiles run concurrently and must treat it as read-only.
+  FrameArena* arena;
+  // Effects with persistent per-pixel state get two buffers of
+  // state_bytes_per_pixel bytes per pixel, swapped every frame: the last
+  // frame's state to read, and this frame's to write. Tiles write only
+  // their own pixels. Both are null for stateless effects.
+  const uint8_t* previous_state;
+  uint8_t* state;
+  // Seeds the effect's random choices so output is reproducible.
+  uint64_t seed;
+  // LayerConfig::user_data, for renderers outside the effect registry.
+  const void* user_data;
+};
+
+// Runs once per frame before any tile and does the frame-wide work, such as
+// float math and per-column tables, in |context.arena|. Returns the data
+// handed to every tile, or null if the arena is exhausted.
+using EffectPrepareFn = const void* (*)(const EffectContext& context);
+
+// Renders |tile| into |out|, which points at the tile's first pixel, as
+// premultiplied RGBA (PixelFormat::kRgba). The pipeline converts to wire
+// order when it packs packets. Called concurrently for different tiles and
+// must not allocate from the heap.
+using EffectRenderFn = void (*)(const void* prepared,
+                                const EffectContext& context, const Tile& tile,
+                                uint8_t* out);
+
+struct EffectRenderer {
+  EffectPrepareFn prepare = nullptr;
+  EffectRenderFn render = nullptr;
+};
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_EFFECT_H_
@@ -0,0 +1,137 @@
+#ifndef BLINKY_ENGINE_EFFECT_REGISTRY_H_
+#define BLINKY_ENGINE_EFFECT_REGISTRY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "engine/effect.h"
+#include "engine/palette.h"
+#include "engine/pixel_format.h"
+#include "engine/render_pipeline.h"
+
+namespace blinky {
+
+// Stable effect identifiers. The values are the effects' indices in
+// kEffects and are what the app stores and sends over FFI, so append new
+// effects at the end.
+enum class EffectId : uint16_t {
+  kRainbowSwirl,
+  kColorMoodBlobs,
+  kPoliceLights,
+  kStrobeWhite,
+  kFire,
+  kOceanWaves,
+  kPulsingPurple,
+  kTwinkle,
+  kWarmSunset,
+  kIceBlue,
+  kForestGreen,
+  kCandyCane,
+  kMatrixRain,
+  kHeartbeat,
+  kNorthernLights,
+  kLavaLamp,
+};
+
+constexpr size_t kEffectCount = 16;
+
+// Matches the category names shown in the app.
+enum class EffectCategory : uint8_t {
+  kAnimated,
+  kStatic,
+  kParty,
+};
+
+struct EffectParam {
+  const char* name;
+  float min;
+  float max;
+  float default_value;
+};
+
+struct EffectInfo {
+  EffectId id;
+  // Display name, as shown on the effect card.
+  const char* name;
+  EffectCategory category;
+  // Name of the PaletteLibrary palette the effect samples, or null.
+  const char* palette;
+  // Persistent per-pixel state the effect keeps between frames.
+  uint8_t state_bytes_per_pixel;
+  uint8_t param_count;
+  EffectParam params[kMaxLayerParams];
+};
+
+inline constexpr EffectInfo kEffects[kEffectCount] = {
+    {EffectId::kRainbowSwirl, "Rainbow Swirl", EffectCategory::kAnimated,
+     nullptr, 0, 2,
+     {{"speed", 0.1f, 5.0f, 1.0f}, {"scale", 0.1f, 4.0f, 1.0f}}},
+    {EffectId::kColorMoodBlobs, "Color Mood Blobs", EffectCategory::kAnimated,
+     nullptr, 0, 2,
+     {{"speed", 0.1f, 3.0f, 0.5f}, {"size", 0.1f, 1.0f, 0.4f}}},
+    {EffectId::kPoliceLights, "Police Lights", EffectCategory::kParty, nullptr,
+     0, 1, {{"speed", 0.5f, 8.0f, 2.0f}}},
+    {EffectId::kStrobeWhite, "Strobe White", EffectCategory::kParty, nullptr, 0,
+     2, {{"rate", 1.0f, 20.0f, 10.0f}, {"duty", 0.05f, 0.5f, 0.1f}}},
+    {EffectId::kFire, "Fire", EffectCategory::kAnimated, "Fire", 1, 2,
+     {{"cooling", 0.0f, 1.0f, 0.35f}, {"sparking", 0.0f, 1.0f, 0.5f}}},
+    {EffectId::kOceanWaves, "Ocean Waves", EffectCategory::kAnimated,
+     "Ocean Waves", 0, 2,
+     {{"speed", 0.1f, 3.0f, 0.6f}, {"scale", 0.1f, 4.0f, 1.0f}}},
+    {EffectId::kPulsingPurple, "Pulsing Purple", EffectCategory::kAnimated,
+     nullptr, 0, 1, {{"speed", 0.1f, 4.0f, 0.5f}}},
+    {EffectId::kTwinkle, "Twinkle", EffectCategory::kStatic, nullptr, 1, 2,
+     {{"density", 0.0f, 0.2f, 0.02f}, {"fade", 0.5f, 0.99f, 0.9f}}},
+    {EffectId::kWarmSunset, "Warm Sunset", EffectCategory::kStatic,
+     "Warm Sunset", 0, 1, {{"drift", 0.0f, 1.0f, 0.1f}}},
+    {EffectId::kIceBlue, "Ice Blue", EffectCategory::kStatic, nullptr, 0, 0,
+     {}},
+    {EffectId::kForestGreen, "Forest Green", EffectCategory::kStatic, nullptr,
+     0, 0, {}},
+    {EffectId::kCandyCane, "Candy Cane", EffectCategory::kParty, "Candy Cane",
+     0, 2, {{"speed", 0.0f, 4.0f, 1.0f}, {"stripes", 1.0f, 16.0f, 4.0f}}},
+    {EffectId::kMatrixRain, "Matrix Rain", EffectCategory::kAnimated, nullptr,
+     0, 2, {{"speed", 0.2f, 4.0f, 1.0f}, {"trail", 0.05f, 1.0f, 0.3f}}},
+    {EffectId::kHeartbeat, "Heartbeat", EffectCategory::kAnimated, nullptr, 0,
+     1, {{"bpm", 40.0f, 180.0f, 72.0f}}},
+    {EffectId::kNorthernLights, "Northern Lights", EffectCategory::kAnimated,
+     "Northern Lights", 0, 2,
+     {{"speed", 0.1f, 3.0f, 0.4f}, {"scale", 0.1f, 4.0f, 1.0f}}},
+    {EffectId::kLavaLamp, "Lava Lamp", EffectCategory::kAnimated, nullptr, 0,
+     2, {{"speed", 0.05f, 2.0f, 0.25f}, {"size", 0.1f, 1.0f, 0.5f}}},
+};
+
+constexpr bool EffectIdsMatchIndices() {
+  for (size_t i = 0; i < kEffectCount; ++i) {
+    if (static_cast<size_t>(kEffects[i].id) != i) return false;
+  }
+  return true;
+}
+
+static_assert(EffectIdsMatchIndices(), "kEffects must be ordered by EffectId");
+
+constexpr const EffectInfo& GetEffectInfo(EffectId id) {
+  return kEffects[static_cast<size_t>(id)];
+}
+
+// Returns the effect with display name |name|, or null. Meant for parsing
+// configuration and command lines, never for per-frame dispatch.
+constexpr const EffectInfo* FindEffect(std::string_view name) {
+  for (const EffectInfo& info : kEffects) {
+    if (name == info.name) return &info;
+  }
+  return nullptr;
+}
+
+// Returns the render functions for |id|. They write RGBA layer pixels, as
+// LayerConfig requires.
+const EffectRenderer& GetEffectRenderer(EffectId id);
+
+// Returns a layer that renders |id| with its default parameters, taking
+// the effect's palette, if it has one, from |palettes|.
+LayerConfig MakeEffectLayer(EffectId id, PaletteLibrary* palettes);
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_EFFECT_REGISTRY_H_
@@ -0,0 +1,597 @@
+// Effect kernels and the render table behind GetEffectRenderer.
+//
+// Each kernel is constructed once per frame in the frame arena, where it
+// does its float math, then shades tiles of pixels with integer arithmetic.
+// Each kernel instantiates RenderEffectTile, so the frame loop makes one
+// indirect call per layer and tile and the pixel loop is branch-free with
+// respect to the effect. Kernels write layer pixels as RGBA only; wire
+// channel order is applied afterwards by the pipeline's PackPixels<Format>.
+
+#include <cmath>
+#include <new>
+#include <type_traits>
+
+#include "engine/effect_registry.h"
+
+namespace blinky {
+
+namespace {
+
+// A full sine period over 256 steps, mapped to 0..255.
+class SineTable {
+ public:
+  SineTable() {
+    for (int i = 0; i < 256; ++i) {
+      values_[i] = static_cast<uint8_t>(
+          std::lround(127.5 + 127.5 * std::sin(i * 2.0 * M_PI / 256.0)));
+    }
+  }
+
+  uint8_t operator()(uint8_t theta) const { return values_[theta]; }
+
+ private:
+  uint8_t values_[256];
+};
+
+const SineTable kSin8;
+
+// Returns the fractional part of |cycles| as an 8-bit angle.
+uint8_t Phase8(double cycles) {
+  return static_cast<uint8_t>(static_cast<int64_t>(std::floor(cycles * 256.0)));
+}
+
+double Fraction(double value) {
+  return value - std::floor(value);
+}
+
+// Stateless noise: the same (seed, frame, index) always gives the same bits.
+uint32_t Noise(uint64_t seed, uint64_t frame, uint64_t index) {
+  return static_cast<uint32_t>(
+      SplitMix64(seed + SplitMix64(frame * 0x9E3779B97F4A7C15ull + index)));
+}
+
+Rgba8 Opaque(uint32_t rgb) {
+  return Rgba8{static_cast<uint8_t>(rgb >> 16), static_cast<uint8_t>(rgb >> 8),
+               static_cast<uint8_t>(rgb), 255};
+}
+
+Rgba8 ScaleOpaque(Rgba8 color, uint8_t level) {
+  return Rgba8{Scale8(color.r, level), Scale8(color.g, level),
+               Scale8(color.b, level), 255};
+}
+
+Rgba8 Hue8ToRgb(uint8_t hue) {
+  const uint8_t region = hue / 43;
+  const uint8_t rising = static_cast<uint8_t>((hue - region * 43) * 6);
+  const uint8_t falling = static_cast<uint8_t>(255 - rising);
+  switch (region) {
+    case 0:
+      return Rgba8{255, rising, 0, 255};
+    case 1:
+      return Rgba8{falling, 255, 0, 255};
+    case 2:
+      return Rgba8{0, 255, rising, 255};
+    case 3:
+      return Rgba8{0, falling, 255, 255};
+    case 4:
+      return Rgba8{rising, 0, 255, 255};
+    default:
+      return Rgba8{255, 0, falling, 255};
+  }
+}
+
+uint32_t MaxDimension(const Layout& layout) {
+  return layout.width > layout.height ? layout.width : layout.height;
+}
+
+// Fixed-point (8.8) step that spans |cycles| 256-step periods over |span|.
+uint32_t SpanStep(double cycles, uint32_t span) {
+  return static_cast<uint32_t>(cycles * 65536.0 / (span > 0 ? span : 1));
+}
+
+// Radial blobs drifting around the layout, shared by Color Mood Blobs and
+// Lava Lamp.
+struct Blob {
+  int32_t x;
+  int32_t y;
+};
+
+Blob PlaceBlob(const Layout& layout, double t, int i) {
+  const uint8_t px = kSin8(Phase8(t * (0.13 + 0.05 * i) + i * 0.33));
+  const uint8_t py = kSin8(Phase8(t * (0.17 + 0.04 * i) + i * 0.21 + 0.25));
+  return Blob{static_cast<int32_t>(px * (layout.width - 1) / 255),
+              static_cast<int32_t>(py * (layout.height - 1) / 255)};
+}
+
+int64_t DistanceSquared(const Blob& blob, uint32_t x, uint32_t y) {
+  const int64_t dx = static_cast<int64_t>(x) - blob.x;
+  const int64_t dy = static_cast<int64_t>(y) - blob.y;
+  return dx * dx + dy * dy;
+}
+
+class RainbowSwirl {
+ public:
+  explicit RainbowSwirl(const EffectContext& context)
+      : offset_(Phase8(context.time * context.params[0] * 0.5)),
+        step_(SpanStep(context.params[1],
+                       context.layout->width + context.layout->height)) {}
+
+  Rgba8 Shade(uint32_t x, uint32_t y, size_t, TileRng&) const {
+    const uint8_t wobble = kSin8(static_cast<uint8_t>(y * 4 + offset_)) >> 3;
+    return Hue8ToRgb(
+        static_cast<uint8_t>(offset_ + wobble + (((x + y) * step_) >> 8)));
+  }
+
+ private:
+  uint8_t offset_;
+  uint32_t step_;
+};
+
+class ColorMoodBlobs {
+ public:
+  explicit ColorMoodBlobs(const EffectContext& context) {
+    const double t = context.time * context.params[0];
+    for (int i = 0; i < kBlobs; ++i) {
+      blobs_[i] = PlaceBlob(*context.layout, t, i);
+    }
+    const double radius = context.params[1] * MaxDimension(*context.layout);
+    radius_squared_ = static_cast<int64_t>(radius * radius) + 1;
+  }
+
+  Rgba8 Shade(uint32_t x, uint32_t y, size_t, TileRng&) const {
+    uint32_t rgb[3] = {kBase.r, kBase.g, kBase.b};
+    for (int i = 0; i < kBlobs; ++i) {
+      const int64_t d2 = DistanceSquared(blobs_[i], x, y);
+      if (d2 >= radius_squared_) continue;
+      const uint32_t falloff =
+          static_cast<uint32_t>(255 - d2 * 255 / radius_squared_);
+      rgb[0] += Scale8(kColors[i].r, static_cast<uint8_t>(falloff));
+      rgb[1] += Scale8(kColors[i].g, static_cast<uint8_t>(falloff));
+      rgb[2] += Scale8(kColors[i].b, static_cast<uint8_t>(falloff));
+    }
+    return Rgba8{static_cast<uint8_t>(rgb[0] > 255 ? 255 : rgb[0]),
+                 static_cast<uint8_t>(rgb[1] > 255 ? 255 : rgb[1]),
+                 static_cast<uint8_t>(rgb[2] > 255 ? 255 : rgb[2]), 255};
+  }
+
+ private:
+  static constexpr int kBlobs = 3;
+  static constexpr Rgba8 kBase = {0x12, 0x08, 0x20, 255};
+  static constexpr Rgba8 kColors[kBlobs] = {
+      {0xFF, 0x4F, 0xA3, 255},
+      {0x4F, 0xC3, 0xFF, 255},
+      {0xB0, 0x6B, 0xFF, 255},
+  };
+
+  Blob blobs_[kBlobs];
+  int64_t radius_squared_;
+};
+
+class PoliceLights {
+ public:
+  explicit PoliceLights(const EffectContext& context)
+      : half_width_(context.layout->width / 2) {
+    const uint64_t step =
+        static_cast<uint64_t>(context.time * context.params[0] * 4.0) & 3;
+    left_ = step == 0 ? Opaque(0xFF0000) : Opaque(0x000000);
+    right_ = step == 2 ? Opaque(0x0033FF) : Opaque(0x000000);
+  }
+
+  Rgba8 Shade(uint32_t x, uint32_t, size_t, TileRng&) const {
+    return x < half_width_ ? left_ : right_;
+  }
+
+ private:
+  uint32_t half_width_;
+  Rgba8 left_;
+  Rgba8 right_;
+};
+
+class StrobeWhite {
+ public:
+  explicit StrobeWhite(const EffectContext& context)
+      : color_(Fraction(context.time * context.params[0]) < context.params[1]
+                   ? Opaque(0xFFFFFF)
+                   : Opaque(0x000000)) {}
+
+  Rgba8 Shade(uint32_t, uint32_t, size_t, TileRng&) const {
+    return color_;
+  }
+
+ private:
+  Rgba8 color_;
+};
+
+// Classic heat simulation: heat drifts upward from the last frame's field,
+// every cell cools a little, and random sparks ignite near the bottom rows.
+// The palette maps heat to color.
+class Fire {
+ public:
+  explicit Fire(const EffectContext& context)
+      : previous_(context.previous_state),
+        heat_(context.state),
+        palette_(context.palette),
+        width_(context.layout->width),
+        height_(context.layout->height),
+        cooling_(static_cast<uint32_t>(context.params[0] * 2000.0f /
+                                       (height_ + 1)) +
+                 2),
+        spark_threshold_(static_cast<uint32_t>(context.params[1] * 16384.0f)),
+        spark_rows_(height_ < 3 ? height_ : 3) {}
+
+  bool valid() const {
+    return previous_ != nullptr && heat_ != nullptr && palette_ != nullptr;
+  }
+
+  Rgba8 Shade(uint32_t, uint32_t y, size_t index, TileRng& rng) const {
+    uint32_t heat = previous_[index];
+    if (y + 1 < height_) {
+      const uint32_t below = previous_[index + width_];
+      const uint32_t below2 =
+          y + 2 < height_ ? previous_[index + 2 * width_] : below;
+      heat = (below + 2 * below2) / 3;
+    }
+    const uint32_t cool = rng.Next() % cooling_;
+    heat = heat > cool ? heat - cool : 0;
+    if (y + spark_rows_ >= height_) {
+      const uint32_t bits = rng.Next();
+      if ((bits & 0xFFFF) < spark_threshold_) {
+        heat += 160 + (bits >> 16) % 96;
+        if (heat > 255) heat = 255;
+      }
+    }
+    heat_[index] = static_cast<uint8_t>(heat);
+    return palette_->Sample(static_cast<uint16_t>(heat * 257));
+  }
+
+ private:
+  const uint8_t* previous_;
+  uint8_t* heat_;
+  const PaletteLut* palette_;
+  uint32_t width_;
+  uint32_t height_;
+  uint32_t cooling_;
+  uint32_t spark_threshold_;
+  uint32_t spark_rows_;
+};
+
+class OceanWaves {
+ public:
+  explicit OceanWaves(const EffectContext& context)
+      : palette_(context.palette),
+        t1_(Phase8(context.time * context.params[0] * 0.25)),
+        t2_(Phase8(context.time * context.params[0] * 0.31)),
+        x_step_(SpanStep(context.params[1], context.layout->width)),
+        y_step_(SpanStep(context.params[1] * 0.5, context.layout->height)) {}
+
+  bool valid() const { return palette_ != nullptr; }
+
+  Rgba8 Shade(uint32_t x, uint32_t y, size_t, TileRng&) const {
+    const uint32_t u = (x * x_step_) >> 8;
+    const uint8_t a = kSin8(static_cast<uint8_t>(u + t1_));
+    const uint8_t b =
+        kSin8(static_cast<uint8_t>(((y * y_step_) >> 8) + (u >> 1) - t2_));
+    return palette_->Sample(static_cast<uint16_t>((a + b) << 7));
+  }
+
+ private:
+  const PaletteLut* palette_;
+  uint8_t t1_;
+  uint8_t t2_;
+  uint32_t x_step_;
+  uint32_t y_step_;
+};
+
+class PulsingPurple {
+ public:
+  explicit PulsingPurple(const EffectContext& context) {
+    const uint8_t wave = kSin8(Phase8(context.time * context.params[0]));
+    color_ = ScaleOpaque(Opaque(0x8A2BE2),
+                         static_cast<uint8_t>(40 + wave * 215 / 255));
+  }
+
+  Rgba8 Shade(uint32_t, uint32_t, size_t, TileRng&) const {
+    return color_;
+  }
+
+ private:
+  Rgba8 color_;
+};
+
+// Each pixel holds a brightness that decays every frame and occasionally
+// relights. Dark pixels are transparent so Twinkle layers over others.
+class Twinkle {
+ public:
+  explicit Twinkle(const EffectContext& context)
+      : previous_(context.previous_state),
+        level_(context.state),
+        fade_(static_cast<uint8_t>(context.params[1] * 255.0f)),
+        threshold_(static_cast<uint32_t>(context.params[0] * 65536.0f)) {}
+
+  bool valid() const { return previous_ != nullptr && level_ != nullptr; }
+
+  Rgba8 Shade(uint32_t, uint32_t, size_t index, TileRng& rng) const {
+    const uint8_t level = (rng.Next() & 0xFFFF) < threshold_
+                              ? 255
+                              : Scale8(previous_[index], fade_);
+    level_[index] = level;
+    return Premultiply(0xFFD9A0, level);
+  }
+
+ private:
+  const uint8_t* previous_;
+  uint8_t* level_;
+  uint8_t fade_;
+  uint32_t threshold_;
+};
+
+class WarmSunset {
+ public:
+  explicit WarmSunset(const EffectContext& context)
+      : palette_(context.palette),
+        row_step_(65535 / (context.layout->height > 1
+                               ? context.layout->height - 1
+                               : 1)),
+        offset_((kSin8(Phase8(context.time * context.params[0] * 0.1)) - 128) *
+                32) {}
+
+  bool valid() const { return palette_ != nullptr; }
+
+  Rgba8 Shade(uint32_t, uint32_t y, size_t, TileRng&) const {
+    int32_t phase = static_cast<int32_t>(y * row_step_) + offset_;
+    phase = phase < 0 ? 0 : (phase > 65535 ? 65535 : phase);
+    return palette_->Sample(static_cast<uint16_t>(phase));
+  }
+
+ private:
+  const PaletteLut* palette_;
+  uint32_t row_step_;
+  int32_t offset_;
+};
+
+template <uint32_t kRgb>
+class SolidColor {
+ public:
+  explicit SolidColor(const EffectContext&) {}
+
+  Rgba8 Shade(uint32_t, uint32_t, size_t, TileRng&) const {
+    return Opaque(kRgb);
+  }
+};
+
+using IceBlue = SolidColor<0xA5F2F3>;
+using ForestGreen = SolidColor<0x228B22>;
+
+class CandyCane {
+ public:
+  explicit CandyCane(const EffectContext& context)
+      : palette_(context.palette),
+        step_(static_cast<uint32_t>(
+            context.params[1] * 65536.0 /
+            (context.layout->width + context.layout->height + 1))),
+        offset_(static_cast<uint32_t>(static_cast<int64_t>(
+            context.time * context.params[0] * 0.5 * 65536.0))) {}
+
+  bool valid() const { return palette_ != nullptr; }
+
+  Rgba8 Shade(uint32_t x, uint32_t y, size_t, TileRng&) const {
+    return palette_->Sample(static_cast<uint16_t>((x + y) * step_ + offset_));
+  }
+
+ private:
+  const PaletteLut* palette_;
+  uint32_t step_;
+  uint32_t offset_;
+};
+
+// Every column has a falling head with a fading trail behind it. Column
+// speeds and offsets come from the seed, so the rain pattern is stable.
+class MatrixRain {
+ public:
+  explicit MatrixRain(const EffectContext& context)
+      : trail_(static_cast<int32_t>(context.params[1] *
+                                    context.layout->height) +
+               1),
+        heads_(context.arena->AllocateArray<int32_t>(context.layout->width)) {
+    if (heads_ == nullptr) return;
+    const double cycle = context.layout->height + trail_;
+    for (uint32_t x = 0; x < context.layout->width; ++x) {
+      const uint32_t bits = Noise(context.seed, 0, x);
+      const double rate = 0.5 + (bits & 0xFF) / 255.0;
+      const double rows_per_second =
+          context.params[0] * rate * context.layout->height * 0.5;
+      const double offset = (bits >> 8) % 1024 / 1024.0 * cycle;
+      heads_[x] = static_cast<int32_t>(
+          std::fmod(context.time * rows_per_second + offset, cycle));
+    }
+  }
+
+  // Prepare fails instead of constructing a kernel without its table.
+  bool valid() const { return heads_ != nullptr; }
+
+  Rgba8 Shade(uint32_t x, uint32_t y, size_t, TileRng&) const {
+    const int32_t behind = heads_[x] - static_cast<int32_t>(y);
+    if (behind == 0) return Opaque(0xCCFFCC);
+    if (behind < 0 || behind >= trail_) return Rgba8{0, 0, 0, 0};
+    const uint8_t level = static_cast<uint8_t>(255 - behind * 255 / trail_);
+    return Rgba8{0, level, Scale8(level, 64), level};
+  }
+
+ private:
+  int32_t trail_;
+  int32_t* heads_;
+};
+
+class Heartbeat {
+ public:
+  explicit Heartbeat(const EffectContext& context) {
+    const double beat = Fraction(context.time * context.params[0] / 60.0);
+    const double lub = Pulse(beat, 0.0, 0.12);
+    const double dub = 0.6 * Pulse(beat, 0.22, 0.12);
+    const double envelope = lub > dub ? lub : dub;
+    color_ = ScaleOpaque(Opaque(0xFF1744),
+                         static_cast<uint8_t>(20 + envelope * 235));
+  }
+
+  Rgba8 Shade(uint32_t, uint32_t, size_t, TileRng&) const {
+    return color_;
+  }
+
+ private:
+  // Sharp attack at |start|, linear decay over |length|.
+  static double Pulse(double beat, double start, double length) {
+    if (beat < start || beat >= start + length) return 0.0;
+    return 1.0 - (beat - start) / length;
+  }
+
+  Rgba8 color_;
+};
+
+class NorthernLights {
+ public:
+  explicit NorthernLights(const EffectContext& context)
+      : palette_(context.palette),
+        t1_(Phase8(context.time * context.params[0] * 0.2)),
+        t2_(Phase8(context.time * context.params[0] * 0.13)),
+        x_step_(SpanStep(context.params[1], context.layout->width)),
+        y_step_(SpanStep(context.params[1] * 0.25, context.layout->height)),
+        fade_step_(191 * 256 / (context.layout->height > 1
+                                    ? context.layout->height - 1
+                                    : 1)) {}
+
+  bool valid() const { return palette_ != nullptr; }
+
+  Rgba8 Shade(uint32_t x, uint32_t y, size_t, TileRng&) const {
+    const uint32_t u = (x * x_step_) >> 8;
+    const uint8_t a = kSin8(static_cast<uint8_t>(u + t1_));
+    const uint8_t b =
+        kSin8(static_cast<uint8_t>((u >> 1) - t2_ + ((y * y_step_) >> 8)));
+    const Rgba8 color = palette_->Sample(static_cast<uint16_t>((a + b) << 7));
+    // Curtains are brightest at the top of the layout.
+    return ScaleOpaque(color,
+                       static_cast<uint8_t>(255 - ((y * fade_step_) >> 8)));
+  }
+
+ private:
+  const PaletteLut* palette_;
+  uint8_t t1_;
+  uint8_t t2_;
+  uint32_t x_step_;
+  uint32_t y_step_;
+  uint32_t fade_step_;
+};
+
+// Metaballs: blob influences add up, and the sum mixes two wax colors.
+class LavaLamp {
+ public:
+  explicit LavaLamp(const EffectContext& context) {
+    const double t = context.time * context.params[0];
+    for (int i = 0; i < kBlobs; ++i) {
+      blobs_[i] = PlaceBlob(*context.layout, t, i);
+    }
+    const double radius = context.params[1] * MaxDimension(*context.layout);
+    radius_squared_ = static_cast<int64_t>(radius * radius) + 1;
+  }
+
+  Rgba8 Shade(uint32_t x, uint32_t y, size_t, TileRng&) const {
+    int64_t field = 0;
+    for (int i = 0; i < kBlobs; ++i) {
+      field += (radius_squared_ << 8) /
+               (DistanceSquared(blobs_[i], x, y) * 4 + radius_squared_);
+    }
+    const uint8_t amount = static_cast<uint8_t>(field > 255 ? 255 : field);
+    return Rgba8{Lerp8(0x3B, 0xFF, amount), Lerp8(0x00, 0x6A, amount),
+                 Lerp8(0x00, 0x00, amount), 255};
+  }
+
+ private:
+  static constexpr int kBlobs = 4;
+
+  Blob blobs_[kBlobs];
+  int64_t radius_squared_;
+};
+
+template <typename Kernel>
+auto KernelValid(const Kernel& kernel, int) -> decltype(kernel.valid()) {
+  return kernel.valid();
+}
+
+template <typename Kernel>
+bool KernelValid(const Kernel&, long) {
+  return true;
+}
+
+template <typename Kernel>
+const void* PrepareEffect(const EffectContext& context) {
+  // Kernels live in the frame arena and are never destroyed.
+  static_assert(std::is_trivially_destructible<Kernel>::value,
+                "effect kernels must be trivially destructible");
+  void* memory = context.arena->Allocate(sizeof(Kernel), alignof(Kernel));
+  if (memory == nullptr) return nullptr;
+  const Kernel* kernel = new (memory) Kernel(context);
+  return KernelValid(*kernel, 0) ? kernel : nullptr;
+}
+
+template <typename Kernel>
+void RenderEffectTile(const void* prepared, const EffectContext& context,
+                      const Tile& tile, uint8_t* out) {
+  const Kernel& kernel = *static_cast<const Kernel*>(prepared);
+  TileRng rng(context.seed, context.frame_index, tile.index);
+  const uint32_t width = context.layout->width;
+  uint32_t x = static_cast<uint32_t>(tile.begin % width);
+  uint32_t y = static_cast<uint32_t>(tile.begin / width);
+  for (size_t index = tile.begin; index < tile.end; ++index) {
+    RgbaPixels::Store(kernel.Shade(x, y, index, rng), out);
+    out += RgbaPixels::kChannels;
+    if (++x == width) {
+      x = 0;
+      ++y;
+    }
+  }
+}
+
+template <typename Kernel>
+constexpr EffectRenderer MakeRenderer() {
+  return EffectRenderer{PrepareEffect<Kernel>, RenderEffectTile<Kernel>};
+}
+
+// Ordered by EffectId.
+constexpr EffectRenderer kRenderers[kEffectCount] = {
+    MakeRenderer<RainbowSwirl>(),
+    MakeRenderer<ColorMoodBlobs>(),
+    MakeRenderer<PoliceLights>(),
+    MakeRenderer<StrobeWhite>(),
+    MakeRenderer<Fire>(),
+    MakeRenderer<OceanWaves>(),
+    MakeRenderer<PulsingPurple>(),
+    MakeRenderer<Twinkle>(),
+    MakeRenderer<WarmSunset>(),
+    MakeRenderer<IceBlue>(),
+    MakeRenderer<ForestGreen>(),
+    MakeRenderer<CandyCane>(),
+    MakeRenderer<MatrixRain>(),
+    MakeRenderer<Heartbeat>(),
+    MakeRenderer<NorthernLights>(),
+    MakeRenderer<LavaLamp>(),
+};
+
+}  // namespace
+
+const EffectRenderer& GetEffectRenderer(EffectId id) {
+  return kRenderers[static_cast<size_t>(id)];
+}
+
+LayerConfig MakeEffectLayer(EffectId id, PaletteLibrary* palettes) {
+  const EffectInfo& info = GetEffectInfo(id);
+  LayerConfig config;
+  config.renderer = GetEffectRenderer(id);
+  if (info.palette != nullptr) config.palette = palettes->Get(info.palette);
+  for (size_t i = 0; i < info.param_count; ++i) {
+    config.params[i] = info.params[i].default_value;
+  }
+  config.state_bytes_per_pixel = info.state_bytes_per_pixel;
+  config.seed = SplitMix64(static_cast<uint64_t>(id) + 1);
+  return config;
+}
+
+}  // namespace blinky
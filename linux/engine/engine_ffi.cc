@@ -0,0 +1,62 @@
+#include "engine/engine_ffi.h"
+
+#include "engine/effect_registry.h"
+
+namespace {
+
+const blinky::EffectInfo* Lookup(uint32_t id) {
+  return id < blinky::kEffectCount ? &blinky::kEffects[id] : nullptr;
+}
+
+const blinky::EffectParam* LookupParam(uint32_t id, uint32_t param) {
+  const blinky::EffectInfo* info = Lookup(id);
+  return info != nullptr && param < info->param_count ? &info->params[param]
+                                                      : nullptr;
+}
+
+}  // namespace
+
+uint32_t blinky_effect_count(void) {
+  return blinky::kEffectCount;
+}
+
+int32_t blinky_effect_find(const char* name) {
+  if (name == nullptr) return -1;
+  const blinky::EffectInfo* info = blinky::FindEffect(name);
+  return info != nullptr ? static_cast<int32_t>(info->id) : -1;
+}
+
+const char* blinky_effect_name(uint32_t id) {
+  const blinky::EffectInfo* info = Lookup(id);
+  return info != nullptr ? info->name : nullptr;
+}
+
+uint32_t blinky_effect_category(uint32_t id) {
+  const blinky::EffectInfo* info = Lookup(id);
+  return info != nullptr ? static_cast<uint32_t>(info->category) : 0;
+}
+
+uint32_t blinky_effect_param_count(uint32_t id) {
+  const blinky::EffectInfo* info = Lookup(id);
+  return info != nullptr ? info->param_count : 0;
+}
+
+const char* blinky_effect_param_name(uint32_t id, uint32_t param) {
+  const blinky::EffectParam* info = LookupParam(id, param);
+  return info != nullptr ? info->name : nullptr;
+}
+
+float blinky_effect_param_min(uint32_t id, uint32_t param) {
+  const blinky::EffectParam* info = LookupParam(id, param);
+  return info != nullptr ? info->min : 0.0f;
+}
+
+float blinky_effect_param_max(uint32_t id, uint32_t param) {
+  const blinky::EffectParam* info = LookupParam(id, param);
+  return info != nullptr ? info->max : 0.0f;
+}
+
+float blinky_effect_param_default(uint32_t id, uint32_t param) {
+  const blinky::EffectParam* info = LookupParam(id, param);
+  return info != nullptr ? info->default_value : 0.0f;
+}
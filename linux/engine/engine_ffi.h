@@ -0,0 +1,37 @@
+#ifndef BLINKY_ENGINE_ENGINE_FFI_H_
+#define BLINKY_ENGINE_ENGINE_FFI_H_
+
+// C interface to the effect registry, loaded by the app through dart:ffi
+// (see lib/core/effect_registry.dart). Effect ids are indices in
+// blinky::kEffects; out-of-range ids yield null strings and zero counts.
+
+#include <stdint.h>
+
+#define BLINKY_EXPORT __attribute__((visibility("default")))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BLINKY_EXPORT uint32_t blinky_effect_count(void);
+
+// Returns the id of the effect with display name |name|, or -1.
+BLINKY_EXPORT int32_t blinky_effect_find(const char* name);
+
+BLINKY_EXPORT const char* blinky_effect_name(uint32_t id);
+
+// Returns the category: 0 Animated, 1 Static, 2 Party.
+BLINKY_EXPORT uint32_t blinky_effect_category(uint32_t id);
+
+BLINKY_EXPORT uint32_t blinky_effect_param_count(uint32_t id);
+BLINKY_EXPORT const char* blinky_effect_param_name(uint32_t id,
+                                                   uint32_t param);
+BLINKY_EXPORT float blinky_effect_param_min(uint32_t id, uint32_t param);
+BLINKY_EXPORT float blinky_effect_param_max(uint32_t id, uint32_t param);
+BLINKY_EXPORT float blinky_effect_param_default(uint32_t id, uint32_t param);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // BLINKY_ENGINE_ENGINE_FFI_H_
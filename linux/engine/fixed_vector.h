@@ -0,0 +1,90 @@
+#ifndef BLINKY_ENGINE_FIXED_VECTOR_H_
+#define BLINKY_ENGINE_FIXED_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace blinky {
+
+// A vector with inline storage for at most N elements. It never touches the
+// heap, so it is safe to mutate from the frame loop; operations that would
+// exceed the capacity fail instead of growing.
+template <typename T, size_t N>
+class FixedVector {
+ public:
+  FixedVector() = default;
+  ~FixedVector() { clear(); }
+
+  FixedVector(const FixedVector&) = delete;
+  FixedVector& operator=(const FixedVector&) = delete;
+
+  static constexpr size_t capacity() { return N; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ == N; }
+
+  T* data() { return std::launder(reinterpret_cast<T*>(storage_)); }
+  const T* data() const {
+    return std::launder(reinterpret_cast<const T*>(storage_));
+  }
+
+  T& operator[](size_t index) {
+    assert(index < size_);
+    return data()[index];
+  }
+  const T& operator[](size_t index) const {
+    assert(index < size_);
+    return data()[index];
+  }
+
+  T* begin() { return data(); }
+  T* end() { return data() + size_; }
+  const T* begin() const { return data(); }
+  const T* end() const { return data() + size_; }
+
+  // Appends |value|. Returns false if the vector is full.
+  bool push_back(T value) { return insert(size_, std::move(value)); }
+
+  // Inserts |value| before |index|, shifting later elements up. Returns
+  // false if the vector is full.
+  bool insert(size_t index, T value) {
+    assert(index <= size_);
+    if (full()) return false;
+    T* items = data();
+    if (index == size_) {
+      new (items + size_) T(std::move(value));
+    } else {
+      new (items + size_) T(std::move(items[size_ - 1]));
+      for (size_t i = size_ - 1; i > index; --i) {
+        items[i] = std::move(items[i - 1]);
+      }
+      items[index] = std::move(value);
+    }
+    ++size_;
+    return true;
+  }
+
+  // Removes the element at |index|, shifting later elements down.
+  void erase(size_t index) {
+    assert(index < size_);
+    T* items = data();
+    for (size_t i = index; i + 1 < size_; ++i) {
+      items[i] = std::move(items[i + 1]);
+    }
+    items[--size_].~T();
+  }
+
+  void clear() {
+    while (size_ > 0) data()[--size_].~T();
+  }
+
+ private:
+  alignas(T) unsigned char storage_[N * sizeof(T)];
+  size_t size_ = 0;
+};
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_FIXED_VECTOR_H_
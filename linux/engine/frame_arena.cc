@@ -0,0 +1,23 @@
+#include "engine/frame_arena.h"
+
+#include <cstdint>
+
+namespace blinky {
+
+FrameArena::FrameArena(size_t capacity_bytes)
+    : block_(new unsigned char[capacity_bytes]), capacity_(capacity_bytes) {}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+  const uintptr_t base = reinterpret_cast<uintptr_t>(block_.get());
+  const uintptr_t aligned = (base + used_ + alignment - 1) & ~(alignment - 1);
+  const size_t offset = aligned - base;
+  if (offset > capacity_ || size > capacity_ - offset) {
+    ++failed_allocations_;
+    return nullptr;
+  }
+  used_ = offset + size;
+  if (used_ > high_water_) high_water_ = used_;
+  return block_.get() + offset;
+}
+
+}  // namespace blinky
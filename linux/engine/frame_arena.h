@@ -0,0 +1,49 @@
+#ifndef BLINKY_ENGINE_FRAME_ARENA_H_
+#define BLINKY_ENGINE_FRAME_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+
+namespace blinky {
+
+// A bump allocator for scratch memory that lives for one frame. The block is
+// allocated once up front; Reset() at the start of each frame reclaims
+// everything in O(1) without touching the heap.
+class FrameArena {
+ public:
+  explicit FrameArena(size_t capacity_bytes);
+
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  // Returns |size| bytes aligned to |alignment| (a power of two), or null
+  // if the arena is exhausted.
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  // Returns uninitialized storage for |count| objects of type T, or null.
+  template <typename T>
+  T* AllocateArray(size_t count) {
+    return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  // Releases every allocation made since the last reset.
+  void Reset() { used_ = 0; }
+
+  size_t capacity() const { return capacity_; }
+  size_t used() const { return used_; }
+  // The most bytes in use at once since construction.
+  size_t high_water() const { return high_water_; }
+  // Allocations refused because the arena was full.
+  size_t failed_allocations() const { return failed_allocations_; }
+
+ private:
+  std::unique_ptr<unsigned char[]> block_;
+  size_t capacity_;
+  size_t used_ = 0;
+  size_t high_water_ = 0;
+  size_t failed_allocations_ = 0;
+};
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_FRAME_ARENA_H_
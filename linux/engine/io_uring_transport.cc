@@ -0,0 +1,262 @@
+#include "engine/io_uring_transport.h"
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace blinky {
+
+namespace {
+
+// Frames with more packets than this are sent in several batches.
+constexpr unsigned kMaxRingEntries = 4096;
+
+// Ask for the file's current position, which is the only meaningful one
+// for sockets and serial ports.
+constexpr uint64_t kCurrentPosition = ~uint64_t{0};
+
+int IoUringSetup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int fd, unsigned to_submit, unsigned min_complete,
+                 unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+int IoUringRegister(int fd, unsigned opcode, const void* arg,
+                    unsigned count) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+// The rings are shared with the kernel, which reads our tails and writes
+// our heads concurrently.
+unsigned LoadAcquire(const unsigned* value) {
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+void StoreRelease(unsigned* value, unsigned new_value) {
+  __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+T* RingField(void* ring, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<uint8_t*>(ring) + offset);
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<IoUringTransport> IoUringTransport::Create(
+    std::vector<OutputTarget> targets, size_t max_packets_per_frame,
+    const uint8_t* packet_memory, size_t packet_memory_size) {
+  std::unique_ptr<IoUringTransport> transport(
+      new IoUringTransport(std::move(targets)));
+  const unsigned entries = static_cast<unsigned>(
+      std::min<size_t>(std::max<size_t>(max_packets_per_frame, 1),
+                       kMaxRingEntries));
+  if (!transport->Init(entries)) return nullptr;
+  transport->RegisterBuffers(packet_memory, packet_memory_size);
+  return transport;
+}
+
+IoUringTransport::IoUringTransport(std::vector<OutputTarget> targets)
+    : OutputTransport(std::move(targets)) {}
+
+IoUringTransport::~IoUringTransport() {
+  if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+  // Closing the ring also drops the buffer registration.
+  if (ring_fd_ >= 0) close(ring_fd_);
+}
+
+bool IoUringTransport::Init(unsigned entries) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  ring_fd_ = IoUringSetup(entries, &params);
+  if (ring_fd_ < 0) return false;
+  if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) return false;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    return false;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      return false;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) return false;
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  sq_head_ = RingField<unsigned>(sq_ring_, params.sq_off.head);
+  sq_tail_ = RingField<unsigned>(sq_ring_, params.sq_off.tail);
+  sq_mask_ = *RingField<unsigned>(sq_ring_, params.sq_off.ring_mask);
+  sq_array_ = RingField<unsigned>(sq_ring_, params.sq_off.array);
+  sq_entries_ = params.sq_entries;
+  sq_local_tail_ = *sq_tail_;
+  cq_head_ = RingField<unsigned>(cq_ring_, params.cq_off.head);
+  cq_tail_ = RingField<unsigned>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = *RingField<unsigned>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = RingField<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+
+  messages_.reset(new msghdr[sq_entries_]());
+  iovecs_.reset(new iovec[sq_entries_]());
+  pending_.reset(new PendingSend[sq_entries_]());
+  return true;
+}
+
+void IoUringTransport::RegisterBuffers(const uint8_t* memory, size_t size) {
+  if (memory == nullptr || size == 0) return;
+  // The kernel only reads from the buffer for writes and sends.
+  const iovec region = {const_cast<uint8_t*>(memory), size};
+  if (IoUringRegister(ring_fd_, IORING_REGISTER_BUFFERS, &region, 1) != 0) {
+    return;
+  }
+  fixed_base_ = memory;
+  fixed_size_ = size;
+}
+
+bool IoUringTransport::Send(const Frame& frame) {
+  const uint64_t errors_before = stats_.send_errors;
+  unsigned queued = 0;
+  for (size_t i = 0; i < frame.packet_count; ++i) {
+    const Packet& packet = frame.packets[i];
+    const OutputTarget* target = Route(packet.universe);
+    if (target == nullptr) {
+      ++stats_.packets_unrouted;
+      continue;
+    }
+    if (queued == sq_entries_) {
+      Flush(queued);
+      queued = 0;
+    }
+    if (ring_failed_) {
+      SendPacket(*target, packet);
+      continue;
+    }
+
+    const unsigned index = sq_local_tail_ & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = target->fd;
+    // Completions report the expected size back so short sends show up.
+    sqe->user_data = packet.size;
+    if (target->address_length == 0) {
+      const bool fixed = packet.data >= fixed_base_ &&
+                         packet.data + packet.size <= fixed_base_ + fixed_size_;
+      sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+      sqe->addr = reinterpret_cast<uintptr_t>(packet.data);
+      sqe->len = packet.size;
+      sqe->off = kCurrentPosition;
+      sqe->buf_index = 0;
+    } else {
+      iovecs_[index] = iovec{packet.data, packet.size};
+      msghdr& message = messages_[index];
+      message = msghdr();
+      message.msg_name = const_cast<sockaddr_storage*>(&target->address);
+      message.msg_namelen = target->address_length;
+      message.msg_iov = &iovecs_[index];
+      message.msg_iovlen = 1;
+      sqe->opcode = IORING_OP_SENDMSG;
+      sqe->addr = reinterpret_cast<uintptr_t>(&message);
+      sqe->len = 1;
+    }
+    pending_[index] = PendingSend{target, packet};
+    sq_array_[index] = index;
+    ++sq_local_tail_;
+    ++queued;
+  }
+  if (queued != 0) Flush(queued);
+  ++stats_.frames_sent;
+  return stats_.send_errors == errors_before;
+}
+
+void IoUringTransport::Flush(unsigned count) {
+  StoreRelease(sq_tail_, sq_local_tail_);
+  unsigned completed = 0;
+  while (completed < count) {
+    // Nonzero only if an earlier call was interrupted before submitting.
+    const unsigned unsubmitted = sq_local_tail_ - LoadAcquire(sq_head_);
+    ++stats_.syscalls;
+    const int result = IoUringEnter(ring_fd_, unsubmitted, count - completed,
+                                    IORING_ENTER_GETEVENTS);
+    const int error = errno;
+    completed += Reap();
+    if (result >= 0 || error == EINTR || error == EAGAIN || error == EBUSY) {
+      continue;
+    }
+    // The ring itself failed; Send() stops using it after this batch.
+    stats_.last_error = error;
+    ring_failed_ = true;
+    const unsigned head = LoadAcquire(sq_head_);
+    const unsigned withdrawn = sq_local_tail_ - head;
+    if (withdrawn != 0) {
+      // Without SQPOLL the kernel only consumes entries inside
+      // io_uring_enter(), so withdrawing the ones it never took is safe,
+      // and they go out by syscall instead. Those it did take are in
+      // flight and may still read packet data, so keep waiting for them.
+      for (unsigned position = head; position != sq_local_tail_; ++position) {
+        const PendingSend& pending = pending_[position & sq_mask_];
+        SendPacket(*pending.target, pending.packet);
+      }
+      sq_local_tail_ = head;
+      StoreRelease(sq_tail_, sq_local_tail_);
+      count -= withdrawn;
+      continue;
+    }
+    // Waiting fails too, so entries still in flight can't be waited for.
+    // Their late completions are never reaped, so they can't be mistaken
+    // for a later frame's, and packet memory belongs to the pipeline and
+    // outlives the frame, so a late send reads stale pixels, never freed
+    // memory.
+    stats_.send_errors += count - completed;
+    return;
+  }
+}
+
+void IoUringTransport::CloseRingForTesting() {
+  close(ring_fd_);
+  ring_fd_ = -1;
+}
+
+unsigned IoUringTransport::Reap() {
+  unsigned head = *cq_head_;
+  const unsigned tail = LoadAcquire(cq_tail_);
+  const unsigned count = tail - head;
+  for (; head != tail; ++head) {
+    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    CountSend(cqe.res, static_cast<size_t>(cqe.user_data));
+  }
+  StoreRelease(cq_head_, head);
+  return count;
+}
+
+}  // namespace blinky
@@ -0,0 +1,118 @@
+#ifndef BLINKY_ENGINE_IO_URING_TRANSPORT_H_
+#define BLINKY_ENGINE_IO_URING_TRANSPORT_H_
+
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "engine/output_transport.h"
+
+namespace blinky {
+
+// Sends frames through an io_uring: Send() queues a submission per packet
+// and makes a single io_uring_enter() call that both submits them and waits
+// for their completions, which are then checked for errors straight from
+// the completion ring. A frame costs one syscall however many controllers
+// it goes to.
+//
+// The pipeline's packet memory is registered with the ring once, so
+// writes to serial ports and connected sockets use IORING_OP_WRITE_FIXED
+// and skip per-send page mapping. Datagrams with an explicit destination
+// go out as IORING_OP_SENDMSG.
+//
+// If the ring itself stops working, the transport falls back to one
+// syscall per packet for good, and backend() reports kSyscall from then on.
+//
+// Fewer syscalls have not yet meant clearly less CPU. On a one-core VM
+// sending 192 packets per frame to receivers behind a veth pair in another
+// network namespace, connected writes took about 10% less CPU than
+// SyscallTransport, and sendto() showed no consistent gain. Most of the
+// cost is the UDP stack itself, which both backends pay. Measure
+// (tools/output_benchmark --remote) before preferring this backend.
+//
+// Talks to the kernel through the raw syscalls, so there is no liburing
+// dependency.
+class IoUringTransport : public OutputTransport {
+ public:
+  // Returns null if the kernel lacks io_uring (or the features used here,
+  // from Linux 5.6) or it is disabled. |packet_memory| is registered as
+  // fixed buffers when the memlock limit allows; otherwise sends fall
+  // back to unregistered writes.
+  static std::unique_ptr<IoUringTransport> Create(
+      std::vector<OutputTarget> targets, size_t max_packets_per_frame,
+      const uint8_t* packet_memory, size_t packet_memory_size);
+
+  ~IoUringTransport() override;
+
+  OutputBackend backend() const override {
+    return ring_failed_ ? OutputBackend::kSyscall : OutputBackend::kIoUring;
+  }
+  bool Send(const Frame& frame) override;
+
+  bool buffers_registered() const { return fixed_size_ != 0; }
+
+  // Closes the ring as if it had failed, so tests can exercise the
+  // fallback to syscalls.
+  void CloseRingForTesting();
+
+ private:
+  // What a submission slot sends, so it can be resent if the ring fails
+  // before the kernel takes it.
+  struct PendingSend {
+    const OutputTarget* target;
+    Packet packet;
+  };
+
+  explicit IoUringTransport(std::vector<OutputTarget> targets);
+
+  bool Init(unsigned entries);
+  void RegisterBuffers(const uint8_t* memory, size_t size);
+  // Submits the |count| queued entries and reaps all their completions.
+  // If the ring fails, sets ring_failed_, resends the entries the kernel
+  // never took with syscalls, and still waits for every entry it did take,
+  // unless waiting fails too.
+  void Flush(unsigned count);
+  // Consumes every available completion. Returns how many there were.
+  unsigned Reap();
+
+  int ring_fd_ = -1;
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_entries_ = 0;
+  unsigned sq_local_tail_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  // Set once io_uring_enter() fails for a reason other than an interrupt
+  // or a full completion queue; Send() then uses plain syscalls.
+  bool ring_failed_ = false;
+
+  const uint8_t* fixed_base_ = nullptr;
+  size_t fixed_size_ = 0;
+
+  // SENDMSG arguments, one per submission slot; the kernel reads them
+  // until the submission completes.
+  std::unique_ptr<msghdr[]> messages_;
+  std::unique_ptr<iovec[]> iovecs_;
+  std::unique_ptr<PendingSend[]> pending_;
+};
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_IO_URING_TRANSPORT_H_
@@ -0,0 +1,84 @@
+#include "engine/output_transport.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <utility>
+
+#ifdef BLINKY_ENGINE_IO_URING
+#include "engine/io_uring_transport.h"
+#endif
+
+namespace blinky {
+
+OutputTransport::OutputTransport(std::vector<OutputTarget> targets)
+    : targets_(std::move(targets)) {
+  for (size_t i = 0; i < targets_.size(); ++i) {
+    const OutputTarget& target = targets_[i];
+    const size_t end = size_t{target.first_universe} + target.universe_count;
+    if (routes_.size() < end) routes_.resize(end, -1);
+    for (size_t universe = target.first_universe; universe < end;
+         ++universe) {
+      routes_[universe] = static_cast<int>(i);
+    }
+  }
+}
+
+void OutputTransport::CountSend(long result, size_t size) {
+  if (result == static_cast<long>(size)) {
+    ++stats_.packets_sent;
+    return;
+  }
+  ++stats_.send_errors;
+  // A short datagram or serial write counts as an I/O error.
+  stats_.last_error = result < 0 ? static_cast<int>(-result) : EIO;
+}
+
+void OutputTransport::SendPacket(const OutputTarget& target,
+                                 const Packet& packet) {
+  ssize_t sent;
+  do {
+    ++stats_.syscalls;
+    sent = target.address_length == 0
+               ? write(target.fd, packet.data, packet.size)
+               : sendto(target.fd, packet.data, packet.size, 0,
+                        reinterpret_cast<const sockaddr*>(&target.address),
+                        target.address_length);
+  } while (sent < 0 && errno == EINTR);
+  CountSend(sent < 0 ? -errno : sent, packet.size);
+}
+
+SyscallTransport::SyscallTransport(std::vector<OutputTarget> targets)
+    : OutputTransport(std::move(targets)) {}
+
+bool SyscallTransport::Send(const Frame& frame) {
+  const uint64_t errors_before = stats_.send_errors;
+  for (size_t i = 0; i < frame.packet_count; ++i) {
+    const Packet& packet = frame.packets[i];
+    const OutputTarget* target = Route(packet.universe);
+    if (target == nullptr) {
+      ++stats_.packets_unrouted;
+      continue;
+    }
+    SendPacket(*target, packet);
+  }
+  ++stats_.frames_sent;
+  return stats_.send_errors == errors_before;
+}
+
+std::unique_ptr<OutputTransport> CreateOutputTransport(
+    OutputBackend backend, std::vector<OutputTarget> targets,
+    const RenderPipeline& pipeline) {
+#ifdef BLINKY_ENGINE_IO_URING
+  if (backend == OutputBackend::kIoUring) {
+    std::unique_ptr<OutputTransport> transport = IoUringTransport::Create(
+        targets, pipeline.packets_per_frame(), pipeline.packet_memory(),
+        pipeline.packet_memory_size());
+    if (transport != nullptr) return transport;
+  }
+#endif
+  return std::unique_ptr<OutputTransport>(
+      new SyscallTransport(std::move(targets)));
+}
+
+}  // namespace blinky
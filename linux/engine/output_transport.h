@@ -0,0 +1,111 @@
+#ifndef BLINKY_ENGINE_OUTPUT_TRANSPORT_H_
+#define BLINKY_ENGINE_OUTPUT_TRANSPORT_H_
+
+#include <sys/socket.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "engine/render_pipeline.h"
+
+namespace blinky {
+
+// A controller that receives a run of universes.
+struct OutputTarget {
+  int fd = -1;
+  // Datagram destination for sendto(). Zero length writes to |fd| instead,
+  // for serial ports and connected sockets.
+  sockaddr_storage address = {};
+  socklen_t address_length = 0;
+  // Packets for universes [first_universe, first_universe + universe_count)
+  // go to this target.
+  uint16_t first_universe = 0;
+  uint16_t universe_count = 1;
+};
+
+struct OutputStats {
+  uint64_t frames_sent = 0;
+  uint64_t packets_sent = 0;
+  // Packets whose universe no target covers.
+  uint64_t packets_unrouted = 0;
+  // Failed or short sends.
+  uint64_t send_errors = 0;
+  // errno of the most recent failed send.
+  int last_error = 0;
+  // System calls made by Send().
+  uint64_t syscalls = 0;
+};
+
+enum class OutputBackend {
+  // One sendto() or write() per packet.
+  kSyscall,
+  // Every packet of a frame submitted and reaped with one io_uring_enter().
+  kIoUring,
+};
+
+// Sends rendered frames to output targets. Targets' file descriptors stay
+// owned by the caller and must outlive the transport. Not thread-safe: each
+// output thread uses its own transport.
+class OutputTransport {
+ public:
+  virtual ~OutputTransport() = default;
+
+  OutputTransport(const OutputTransport&) = delete;
+  OutputTransport& operator=(const OutputTransport&) = delete;
+
+  virtual OutputBackend backend() const = 0;
+
+  // Sends every routed packet of |frame| and returns once the kernel is
+  // done with the packet data, so the frame can be released right away.
+  // Returns false if any send failed; see stats() for details.
+  virtual bool Send(const Frame& frame) = 0;
+
+  const OutputStats& stats() const { return stats_; }
+
+ protected:
+  explicit OutputTransport(std::vector<OutputTarget> targets);
+
+  // Returns the target for |universe|, or null if none covers it.
+  const OutputTarget* Route(uint16_t universe) const {
+    return universe < routes_.size() && routes_[universe] >= 0
+               ? &targets_[routes_[universe]]
+               : nullptr;
+  }
+
+  // Records the outcome of sending one packet of |size| bytes, where
+  // |result| is the byte count sent or a negated errno.
+  void CountSend(long result, size_t size);
+
+  // Sends |packet| to |target| with one sendto() or write().
+  void SendPacket(const OutputTarget& target, const Packet& packet);
+
+  OutputStats stats_;
+
+ private:
+  std::vector<OutputTarget> targets_;
+  // Target index for each universe, or -1.
+  std::vector<int> routes_;
+};
+
+// The classic path: one sendto() or write() per packet.
+class SyscallTransport : public OutputTransport {
+ public:
+  explicit SyscallTransport(std::vector<OutputTarget> targets);
+
+  OutputBackend backend() const override { return OutputBackend::kSyscall; }
+  bool Send(const Frame& frame) override;
+};
+
+// Returns a transport for |pipeline|'s frames using |backend|. Falls back to
+// SyscallTransport when io_uring is requested but the engine was built
+// without it or the kernel refuses it; check backend() to see which one
+// was created.
+std::unique_ptr<OutputTransport> CreateOutputTransport(
+    OutputBackend backend, std::vector<OutputTarget> targets,
+    const RenderPipeline& pipeline);
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_OUTPUT_TRANSPORT_H_
@@ -0,0 +1,226 @@
+#include "engine/palette.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace blinky {
+
+namespace {
+
+constexpr GradientStop kWarmSunsetStops[] = {
+    {0.00f, "#2B1055"}, {0.35f, "#D6246E"}, {0.70f, "#F29F58"},
+    {1.00f, "#FFD56B"},
+};
+
+constexpr GradientStop kOceanWavesStops[] = {
+    {0.00f, "#001F3F"}, {0.30f, "#0074D9"}, {0.50f, "#39CCCC"},
+    {0.70f, "#0074D9"}, {1.00f, "#001F3F"},
+};
+
+constexpr GradientStop kNorthernLightsStops[] = {
+    {0.00f, "#0B0C2A"}, {0.25f, "#1B998B"}, {0.45f, "#2DE1C2"},
+    {0.70f, "#7B2CBF"}, {1.00f, "#0B0C2A"},
+};
+
+// Indexed by heat, from cold embers to white-hot.
+constexpr GradientStop kFireStops[] = {
+    {0.00f, "#000000"}, {0.30f, "#8B0000"}, {0.55f, "#FF4500"},
+    {0.80f, "#FFA500"}, {0.95f, "#FFFF66"}, {1.00f, "#FFFFFF"},
+};
+
+constexpr GradientStop kCandyCaneStops[] = {
+    {0.00f, "#FF0000"}, {0.50f, "#FF0000"}, {0.50f, "#FFFFFF"},
+    {1.00f, "#FFFFFF"},
+};
+
+template <size_t N>
+BuiltinPalette MakeBuiltin(const char* name, const GradientStop (&stops)[N]) {
+  return BuiltinPalette{name, stops, N};
+}
+
+unsigned Log2(size_t value) {
+  unsigned result = 0;
+  while ((size_t{1} << result) < value) ++result;
+  return result;
+}
+
+}  // namespace
+
+PaletteLut::PaletteLut(size_t size)
+    : entries_(size, Rgba8{0, 0, 0, 0}), phase_shift_(16 - Log2(size)) {
+  assert(size == kSmallSize || size == kLargeSize);
+}
+
+bool CompileGradient(const GradientStop* stops, size_t count, PaletteLut* lut) {
+  std::vector<ColorStop> parsed;
+  if (!ParseGradient(stops, count, &parsed)) return false;
+  CompileGradient(parsed, lut);
+  return true;
+}
+
+bool ParseGradient(const GradientStop* stops, size_t count,
+                   std::vector<ColorStop>* out) {
+  if (count == 0) return false;
+  std::vector<ColorStop> parsed(count);
+  for (size_t i = 0; i < count; ++i) {
+    const GradientStop& stop = stops[i];
+    if (!(stop.position >= 0.0f && stop.position <= 1.0f)) return false;
+    if (i > 0 && stop.position < stops[i - 1].position) return false;
+    uint32_t rgb = 0;
+    if (stop.hex == nullptr || !ParseHexColor(stop.hex, &rgb)) return false;
+    parsed[i] = ColorStop{stop.position, rgb, stop.alpha};
+  }
+  *out = std::move(parsed);
+  return true;
+}
+
+void CompileGradient(const std::vector<ColorStop>& stops, PaletteLut* lut) {
+  assert(!stops.empty());
+  const size_t count = stops.size();
+
+  // Interpolation happens here, once per entry, so render loops never
+  // touch floats for palette lookups.
+  const size_t size = lut->size();
+  Rgba8* out = lut->data();
+  size_t segment = 0;
+  for (size_t i = 0; i < size; ++i) {
+    const float t = static_cast<float>(i) / static_cast<float>(size - 1);
+    while (segment + 1 < count && stops[segment + 1].position <= t) {
+      ++segment;
+    }
+    const ColorStop& lo = stops[segment];
+    const ColorStop& hi = stops[segment + 1 < count ? segment + 1 : segment];
+    const float span = hi.position - lo.position;
+    const float f = (span > 0.0f && t > lo.position)
+                        ? (t - lo.position) / span
+                        : 0.0f;
+    const float lo_channels[4] = {
+        static_cast<float>((lo.rgb >> 16) & 0xFF),
+        static_cast<float>((lo.rgb >> 8) & 0xFF),
+        static_cast<float>(lo.rgb & 0xFF), static_cast<float>(lo.alpha)};
+    const float hi_channels[4] = {
+        static_cast<float>((hi.rgb >> 16) & 0xFF),
+        static_cast<float>((hi.rgb >> 8) & 0xFF),
+        static_cast<float>(hi.rgb & 0xFF), static_cast<float>(hi.alpha)};
+    uint8_t channels[4];
+    for (int c = 0; c < 4; ++c) {
+      const float value =
+          lo_channels[c] + (hi_channels[c] - lo_channels[c]) * f;
+      channels[c] = static_cast<uint8_t>(std::lround(value));
+    }
+    const uint32_t rgb = (uint32_t{channels[0]} << 16) |
+                         (uint32_t{channels[1]} << 8) | channels[2];
+    out[i] = Premultiply(rgb, channels[3]);
+  }
+}
+
+void BlendPalettes(const PaletteLut& from, const PaletteLut& to,
+                   uint8_t amount, PaletteLut* out) {
+  assert(from.size() == to.size() && from.size() == out->size());
+  const Rgba8* a = from.data();
+  const Rgba8* b = to.data();
+  Rgba8* dst = out->data();
+  for (size_t i = 0, n = out->size(); i < n; ++i) {
+    dst[i] = Rgba8{Lerp8(a[i].r, b[i].r, amount), Lerp8(a[i].g, b[i].g, amount),
+                   Lerp8(a[i].b, b[i].b, amount),
+                   Lerp8(a[i].a, b[i].a, amount)};
+  }
+}
+
+void SamplePalette(const PaletteLut& lut, const uint16_t* phases, size_t count,
+                   Rgba8* out) {
+  const Rgba8* entries = lut.data();
+  const unsigned shift = lut.phase_shift();
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = entries[phases[i] >> shift];
+  }
+}
+
+const std::vector<BuiltinPalette>& BuiltinPalettes() {
+  static const std::vector<BuiltinPalette> palettes = {
+      MakeBuiltin("Warm Sunset", kWarmSunsetStops),
+      MakeBuiltin("Ocean Waves", kOceanWavesStops),
+      MakeBuiltin("Northern Lights", kNorthernLightsStops),
+      MakeBuiltin("Fire", kFireStops),
+      MakeBuiltin("Candy Cane", kCandyCaneStops),
+  };
+  return palettes;
+}
+
+PaletteLibrary::PaletteLibrary() {
+  for (const BuiltinPalette& palette : BuiltinPalettes()) {
+    const bool parsed = ParseGradient(palette.stops, palette.stop_count,
+                                      &definitions_[palette.name]);
+    assert(parsed);
+    (void)parsed;
+  }
+}
+
+bool PaletteLibrary::Define(const std::string& name,
+                            std::vector<GradientStop> stops) {
+  std::vector<ColorStop> parsed;
+  if (!ParseGradient(stops.data(), stops.size(), &parsed)) return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  definitions_[name] = std::move(parsed);
+  tables_.erase(tables_.lower_bound({name, 0}),
+                tables_.upper_bound({name, SIZE_MAX}));
+  return true;
+}
+
+std::shared_ptr<const PaletteLut> PaletteLibrary::Get(const std::string& name,
+                                                      size_t size) {
+  if (size != PaletteLut::kSmallSize && size != PaletteLut::kLargeSize) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto cached = tables_.find({name, size});
+  if (cached != tables_.end()) return cached->second;
+
+  auto definition = definitions_.find(name);
+  if (definition == definitions_.end()) return nullptr;
+
+  auto lut = std::make_shared<PaletteLut>(size);
+  CompileGradient(definition->second, lut.get());
+  tables_[{name, size}] = lut;
+  return lut;
+}
+
+PaletteTransition::PaletteTransition(std::shared_ptr<const PaletteLut> palette)
+    : source_(std::move(palette)), blended_(source_->size()) {}
+
+void PaletteTransition::Start(std::shared_ptr<const PaletteLut> target,
+                              double duration_seconds) {
+  assert(target->size() == source_->size());
+  if (amount_ > 0) {
+    // Restart from whatever is on screen so the fade has no visible jump.
+    source_ = std::make_shared<PaletteLut>(blended_);
+  }
+  target_ = std::move(target);
+  duration_ = duration_seconds;
+  elapsed_ = 0.0;
+  amount_ = 0;
+  if (duration_ <= 0.0) Advance(0.0);
+}
+
+void PaletteTransition::Advance(double elapsed_seconds) {
+  if (!target_) return;
+  elapsed_ += elapsed_seconds;
+  if (elapsed_ >= duration_) {
+    source_ = std::move(target_);
+    target_.reset();
+    amount_ = -1;
+    return;
+  }
+  const int amount = static_cast<int>(elapsed_ / duration_ * 255.0);
+  if (amount != amount_) {
+    BlendPalettes(*source_, *target_, static_cast<uint8_t>(amount), &blended_);
+    amount_ = amount;
+  }
+}
+
+const PaletteLut& PaletteTransition::current() const {
+  return amount_ > 0 ? blended_ : *source_;
+}
+
+}  // namespace blinky
@@ -0,0 +1,159 @@
+#ifndef BLINKY_ENGINE_PALETTE_H_
+#define BLINKY_ENGINE_PALETTE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "engine/color.h"
+
+namespace blinky {
+
+// One stop of a gradient definition.
+struct GradientStop {
+  // Position along the gradient, in [0, 1]. Stops must be sorted; two stops
+  // at the same position make a hard edge.
+  float position;
+  // Color in HexInputField format, e.g. "#FF8800". Only read during the
+  // call the stop is passed to; nothing keeps the pointer.
+  const char* hex;
+  // Opacity of the stop. The compiled table is premultiplied by it.
+  uint8_t alpha = 255;
+};
+
+// A gradient stop with its color already parsed.
+struct ColorStop {
+  float position;
+  // 0xRRGGBB.
+  uint32_t rgb;
+  uint8_t alpha;
+};
+
+// A gradient compiled into a power-of-two lookup table of premultiplied
+// colors. Palette-driven effects map a 16-bit phase to an entry with a shift
+// and a single indexed load per pixel.
+class PaletteLut {
+ public:
+  static constexpr size_t kSmallSize = 256;
+  static constexpr size_t kLargeSize = 1024;
+
+  // |size| must be kSmallSize or kLargeSize.
+  explicit PaletteLut(size_t size);
+
+  size_t size() const { return entries_.size(); }
+  const Rgba8* data() const { return entries_.data(); }
+  Rgba8* data() { return entries_.data(); }
+
+  // Right shift that turns a 16-bit phase into a table index.
+  unsigned phase_shift() const { return phase_shift_; }
+
+  // Returns the entry for |phase|, where 0..65535 spans the whole gradient.
+  Rgba8 Sample(uint16_t phase) const { return entries_[phase >> phase_shift_]; }
+
+ private:
+  std::vector<Rgba8> entries_;
+  unsigned phase_shift_;
+};
+
+// Compiles |count| stops into |lut|, interpolating linearly between stops.
+// Returns false if the stops are empty, unsorted, out of range, or contain
+// an unparsable color; |lut| is left unchanged in that case.
+bool CompileGradient(const GradientStop* stops, size_t count, PaletteLut* lut);
+
+// Validates |count| stops and parses their colors into |out|. Returns
+// false, leaving |out| unchanged, under the same conditions as
+// CompileGradient().
+bool ParseGradient(const GradientStop* stops, size_t count,
+                   std::vector<ColorStop>* out);
+
+// Compiles stops from ParseGradient() into |lut|. |stops| must not be
+// empty.
+void CompileGradient(const std::vector<ColorStop>& stops, PaletteLut* lut);
+
+// Writes the per-entry blend of |from| and |to| into |out|, where |amount|
+// 0 is all |from| and 255 is all |to|. All three tables must be the same
+// size; |out| may alias either input.
+void BlendPalettes(const PaletteLut& from, const PaletteLut& to,
+                   uint8_t amount, PaletteLut* out);
+
+// Maps each of |count| phases to its palette entry.
+void SamplePalette(const PaletteLut& lut, const uint16_t* phases, size_t count,
+                   Rgba8* out);
+
+// A gradient definition shipped with the engine.
+struct BuiltinPalette {
+  const char* name;
+  const GradientStop* stops;
+  size_t stop_count;
+};
+
+// Returns the built-in palettes, which are named after the effects that use
+// them (e.g. "Warm Sunset", "Fire").
+const std::vector<BuiltinPalette>& BuiltinPalettes();
+
+// Compiles palettes on first use and hands out shared, immutable tables so
+// every effect and layer using the same palette reads the same memory.
+// Thread-safe; intended to be called when layers are configured, not from
+// pixel loops.
+class PaletteLibrary {
+ public:
+  PaletteLibrary();
+
+  PaletteLibrary(const PaletteLibrary&) = delete;
+  PaletteLibrary& operator=(const PaletteLibrary&) = delete;
+
+  // Adds or replaces the definition for |name|. The stops are parsed and
+  // copied, so their hex strings need only live for the call. Tables
+  // already handed out for the old definition stay valid. Returns false if
+  // the stops don't compile.
+  bool Define(const std::string& name, std::vector<GradientStop> stops);
+
+  // Returns the table for |name| at |size| entries, or null if no palette
+  // of that name is defined or |size| is neither kSmallSize nor kLargeSize.
+  std::shared_ptr<const PaletteLut> Get(const std::string& name,
+                                        size_t size = PaletteLut::kSmallSize);
+
+ private:
+  std::mutex mutex_;
+  std::map<std::string, std::vector<ColorStop>> definitions_;
+  std::map<std::pair<std::string, size_t>, std::shared_ptr<const PaletteLut>>
+      tables_;
+};
+
+// Cross-fades between two palettes over time, re-blending its table only
+// when the 8-bit blend amount changes.
+class PaletteTransition {
+ public:
+  // Starts at |palette| with no transition in progress.
+  explicit PaletteTransition(std::shared_ptr<const PaletteLut> palette);
+
+  // Begins fading from the currently displayed colors to |target| over
+  // |duration_seconds|. |target| must match the current table size.
+  void Start(std::shared_ptr<const PaletteLut> target,
+             double duration_seconds);
+
+  // Advances the transition by |elapsed_seconds|.
+  void Advance(double elapsed_seconds);
+
+  bool active() const { return target_ != nullptr; }
+
+  // The table to render with this frame.
+  const PaletteLut& current() const;
+
+ private:
+  std::shared_ptr<const PaletteLut> source_;
+  std::shared_ptr<const PaletteLut> target_;
+  PaletteLut blended_;
+  double duration_ = 0.0;
+  double elapsed_ = 0.0;
+  int amount_ = -1;
+};
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_PALETTE_H_
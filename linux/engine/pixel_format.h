@@ -0,0 +1,98 @@
+#ifndef BLINKY_ENGINE_PIXEL_FORMAT_H_
+#define BLINKY_ENGINE_PIXEL_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/color.h"
+
+namespace blinky {
+
+// Channel orders the engine can write. kRgba is the premultiplied layout of
+// Rgba8 used for layer buffers; the others are LED strip wire orders.
+enum class PixelFormat : uint8_t {
+  kRgba,
+  kRgb,
+  kGrb,
+  kRgbw,
+};
+
+constexpr size_t kPixelFormatCount = 4;
+
+// Each format type stores one color. Packers are templates over these so
+// the channel order is resolved at compile time and pixel loops never
+// branch on it. Effects always write RgbaPixels.
+struct RgbaPixels {
+  static constexpr PixelFormat kFormat = PixelFormat::kRgba;
+  static constexpr size_t kChannels = 4;
+  static void Store(Rgba8 color, uint8_t* out) {
+    out[0] = color.r;
+    out[1] = color.g;
+    out[2] = color.b;
+    out[3] = color.a;
+  }
+};
+
+struct RgbPixels {
+  static constexpr PixelFormat kFormat = PixelFormat::kRgb;
+  static constexpr size_t kChannels = 3;
+  static void Store(Rgba8 color, uint8_t* out) {
+    out[0] = color.r;
+    out[1] = color.g;
+    out[2] = color.b;
+  }
+};
+
+struct GrbPixels {
+  static constexpr PixelFormat kFormat = PixelFormat::kGrb;
+  static constexpr size_t kChannels = 3;
+  static void Store(Rgba8 color, uint8_t* out) {
+    out[0] = color.g;
+    out[1] = color.r;
+    out[2] = color.b;
+  }
+};
+
+// Moves the common part of R, G and B onto the dedicated white channel.
+struct RgbwPixels {
+  static constexpr PixelFormat kFormat = PixelFormat::kRgbw;
+  static constexpr size_t kChannels = 4;
+  static void Store(Rgba8 color, uint8_t* out) {
+    uint8_t white = color.r < color.g ? color.r : color.g;
+    white = color.b < white ? color.b : white;
+    out[0] = static_cast<uint8_t>(color.r - white);
+    out[1] = static_cast<uint8_t>(color.g - white);
+    out[2] = static_cast<uint8_t>(color.b - white);
+    out[3] = white;
+  }
+};
+
+constexpr size_t ChannelCount(PixelFormat format) {
+  return format == PixelFormat::kRgb || format == PixelFormat::kGrb ? 3 : 4;
+}
+
+// Converts |count| premultiplied pixels to a wire format.
+using PackPixelsFn = void (*)(const Rgba8* pixels, size_t count, uint8_t* out);
+
+template <typename Format>
+void PackPixels(const Rgba8* pixels, size_t count, uint8_t* out) {
+  for (size_t i = 0; i < count; ++i) {
+    Format::Store(pixels[i], out);
+    out += Format::kChannels;
+  }
+}
+
+constexpr PackPixelsFn kPackPixels[kPixelFormatCount] = {
+    PackPixels<RgbaPixels>,
+    PackPixels<RgbPixels>,
+    PackPixels<GrbPixels>,
+    PackPixels<RgbwPixels>,
+};
+
+inline PackPixelsFn GetPixelPacker(PixelFormat format) {
+  return kPackPixels[static_cast<size_t>(format)];
+}
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_PIXEL_FORMAT_H_
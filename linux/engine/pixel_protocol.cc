@@ -0,0 +1,131 @@
+#include "engine/pixel_protocol.h"
+
+#include <cstring>
+
+namespace blinky {
+
+namespace {
+
+// Byte-wise so the format is little-endian on any host; compilers fold
+// these into single loads and stores on little-endian targets.
+void Store16(uint8_t* out, uint16_t value) {
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void Store32(uint8_t* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void Store64(uint8_t* out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint16_t Load16(const uint8_t* data) {
+  return static_cast<uint16_t>(data[0] | data[1] << 8);
+}
+
+uint32_t Load32(const uint8_t* data) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) value |= uint32_t{data[i]} << (8 * i);
+  return value;
+}
+
+uint64_t Load64(const uint8_t* data) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) value |= uint64_t{data[i]} << (8 * i);
+  return value;
+}
+
+bool HasValidPreamble(const uint8_t* data, size_t size, size_t header_size) {
+  return data != nullptr && size >= header_size &&
+         Load32(data) == kPixelProtocolMagic &&
+         Load16(data + 4) == kPixelProtocolVersion;
+}
+
+}  // namespace
+
+size_t PixelRequestSize(const PixelRequest& request) {
+  if (request.type != PixelMessageType::kSetPixels) {
+    return kPixelRequestHeaderSize;
+  }
+  return kPixelRequestHeaderSize + size_t{request.pixel_count} * kPixelBytes;
+}
+
+void EncodePixelRequest(const PixelRequest& request, uint8_t* out) {
+  Store32(out, kPixelProtocolMagic);
+  Store16(out + 4, kPixelProtocolVersion);
+  Store16(out + 6, static_cast<uint16_t>(request.type));
+  Store32(out + 8, request.first_pixel);
+  Store32(out + 12, request.pixel_count);
+  if (request.type == PixelMessageType::kSetPixels &&
+      request.pixel_count != 0) {
+    std::memcpy(out + kPixelRequestHeaderSize, request.pixels,
+                size_t{request.pixel_count} * kPixelBytes);
+  }
+}
+
+bool ParsePixelRequest(const uint8_t* data, size_t size,
+                       PixelRequest* request) {
+  if (!HasValidPreamble(data, size, kPixelRequestHeaderSize)) return false;
+  const uint16_t type = Load16(data + 6);
+  if (type < static_cast<uint16_t>(PixelMessageType::kGetFrame) ||
+      type > static_cast<uint16_t>(PixelMessageType::kSetPixels)) {
+    return false;
+  }
+  request->type = static_cast<PixelMessageType>(type);
+  request->first_pixel = Load32(data + 8);
+  request->pixel_count = Load32(data + 12);
+  request->pixels = nullptr;
+  if (request->type == PixelMessageType::kSetPixels) {
+    if (size - kPixelRequestHeaderSize !=
+        size_t{request->pixel_count} * kPixelBytes) {
+      return false;
+    }
+    request->pixels = data + kPixelRequestHeaderSize;
+  } else if (size != kPixelRequestHeaderSize) {
+    return false;
+  }
+  return true;
+}
+
+void EncodePixelResponseHeader(const PixelResponseHeader& header,
+                               uint8_t* out) {
+  Store32(out, kPixelProtocolMagic);
+  Store16(out + 4, kPixelProtocolVersion);
+  Store16(out + 6, static_cast<uint16_t>(header.status));
+  Store32(out + 8, header.width);
+  Store32(out + 12, header.height);
+  Store64(out + 16, header.frame_index);
+  Store32(out + 24, header.pixel_count);
+  Store32(out + 28, 0);
+}
+
+bool ParsePixelResponseHeader(const uint8_t* data, size_t size,
+                              PixelResponseHeader* header) {
+  if (!HasValidPreamble(data, size, kPixelResponseHeaderSize)) return false;
+  header->status = static_cast<PixelStatus>(Load16(data + 6));
+  header->width = Load32(data + 8);
+  header->height = Load32(data + 12);
+  header->frame_index = Load64(data + 16);
+  header->pixel_count = Load32(data + 24);
+  return true;
+}
+
+void EncodePixelStats(const PipelineStats& stats, uint8_t* out) {
+  Store64(out, stats.frames_rendered);
+  Store64(out + 8, stats.frames_dropped);
+  Store64(out + 16, stats.arena_high_water);
+  Store64(out + 24, stats.heap_allocations);
+}
+
+bool ParsePixelStats(const uint8_t* data, size_t size, PipelineStats* stats) {
+  if (data == nullptr || size < kPixelStatsSize) return false;
+  stats->frames_rendered = Load64(data);
+  stats->frames_dropped = Load64(data + 8);
+  stats->arena_high_water = static_cast<size_t>(Load64(data + 16));
+  stats->heap_allocations = static_cast<size_t>(Load64(data + 24));
+  return true;
+}
+
+}  // namespace blinky
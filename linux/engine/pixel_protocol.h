@@ -0,0 +1,96 @@
+#ifndef BLINKY_ENGINE_PIXEL_PROTOCOL_H_
+#define BLINKY_ENGINE_PIXEL_PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/color.h"
+#include "engine/render_pipeline.h"
+
+namespace blinky {
+
+// Packed binary messages exchanged with the app over the "blinky/pixels"
+// channel (see linux/pixel_channel.h and lib/core/pixel_channel.dart).
+//
+// Every message starts with a fixed little-endian header; pixel payloads
+// follow it as tightly packed RGBA bytes, premultiplied, exactly as the
+// engine stores Rgba8. Nothing is boxed or tagged per value, so a payload
+// moves between the message and engine buffers with one memcpy.
+//
+// Request:  magic u32 | version u16 | type u16 | first_pixel u32 |
+//           pixel_count u32 | [kSetPixels: pixel_count * 4 bytes RGBA]
+// Response: magic u32 | version u16 | status u16 | width u32 | height u32 |
+//           frame_index u64 | pixel_count u32 | reserved u32 |
+//           [kGetFrame: pixel_count * 4 bytes RGBA]
+//           [kGetStats: frames_rendered u64 | frames_dropped u64 |
+//                       arena_high_water u64 | heap_allocations u64]
+
+constexpr uint32_t kPixelProtocolMagic = 0x4B4E4C42;  // "BLNK"
+constexpr uint16_t kPixelProtocolVersion = 1;
+
+constexpr size_t kPixelRequestHeaderSize = 16;
+constexpr size_t kPixelResponseHeaderSize = 32;
+constexpr size_t kPixelStatsSize = 32;
+constexpr size_t kPixelBytes = sizeof(Rgba8);
+
+static_assert(sizeof(Rgba8) == 4, "Rgba8 must be packed RGBA bytes");
+
+enum class PixelMessageType : uint16_t {
+  // Reads pixels of the latest rendered frame.
+  kGetFrame = 1,
+  kGetStats = 2,
+  // Replaces a range of the uploaded zone colors.
+  kSetPixels = 3,
+};
+
+enum class PixelStatus : uint16_t {
+  kOk = 0,
+  kBadRequest = 1,
+  // The requested pixel range is outside the layout.
+  kOutOfRange = 2,
+  // No frame has been rendered yet.
+  kNoFrame = 3,
+};
+
+struct PixelRequest {
+  PixelMessageType type = PixelMessageType::kGetFrame;
+  uint32_t first_pixel = 0;
+  uint32_t pixel_count = 0;
+  // kSetPixels payload, pointing into the parsed message.
+  const uint8_t* pixels = nullptr;
+};
+
+struct PixelResponseHeader {
+  PixelStatus status = PixelStatus::kOk;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint64_t frame_index = 0;
+  uint32_t pixel_count = 0;
+};
+
+// Size of the encoded |request|, payload included.
+size_t PixelRequestSize(const PixelRequest& request);
+
+// Writes |request| to |out|, which must hold PixelRequestSize() bytes.
+void EncodePixelRequest(const PixelRequest& request, uint8_t* out);
+
+// Parses a request without copying its payload. Returns false if |data|
+// is not a well-formed request of this protocol version.
+bool ParsePixelRequest(const uint8_t* data, size_t size,
+                       PixelRequest* request);
+
+// Writes |header| to the first kPixelResponseHeaderSize bytes of |out|.
+void EncodePixelResponseHeader(const PixelResponseHeader& header,
+                               uint8_t* out);
+
+bool ParsePixelResponseHeader(const uint8_t* data, size_t size,
+                              PixelResponseHeader* header);
+
+// Writes |stats| to the first kPixelStatsSize bytes of |out|.
+void EncodePixelStats(const PipelineStats& stats, uint8_t* out);
+
+bool ParsePixelStats(const uint8_t* data, size_t size, PipelineStats* stats);
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_PIXEL_PROTOCOL_H_
@@ -0,0 +1,300 @@
+#include "engine/render_pipeline.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "engine/alloc_guard.h"
+
+namespace blinky {
+
+namespace {
+
+// Frame arena size. It holds prepared effect kernels and their per-frame
+// tables, which are small; layer pixels never go through it.
+constexpr size_t kArenaBytes = 256 * 1024;
+
+// Composites |count| premultiplied |src| pixels at |opacity| over |dst|.
+void CompositeOver(const Rgba8* src, uint8_t opacity, Rgba8* dst,
+                   size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    Rgba8 s = src[i];
+    if (opacity != 255) {
+      s = Rgba8{Scale8(s.r, opacity), Scale8(s.g, opacity),
+                Scale8(s.b, opacity), Scale8(s.a, opacity)};
+    }
+    if (s.a == 255) {
+      dst[i] = s;
+      continue;
+    }
+    const uint8_t keep = static_cast<uint8_t>(255 - s.a);
+    const Rgba8 d = dst[i];
+    dst[i] = Rgba8{static_cast<uint8_t>(s.r + Scale8(d.r, keep)),
+                   static_cast<uint8_t>(s.g + Scale8(d.g, keep)),
+                   static_cast<uint8_t>(s.b + Scale8(d.b, keep)),
+                   static_cast<uint8_t>(s.a + Scale8(d.a, keep))};
+  }
+}
+
+// Adds the allocations made by a task on a pool thread to |total|. Worker 0
+// is the thread inside RenderFrame(), whose own scope already counts them.
+void CountTaskAllocations(size_t worker, const ScopedNoHeapAllocation& scope,
+                          std::atomic<size_t>* total) {
+  if (worker == 0) return;
+  if (const size_t count = scope.allocations()) {
+    total->fetch_add(count, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+RenderPipeline::RenderPipeline(const Layout& layout, PixelFormat output_format,
+                               WorkerPool* pool)
+    : layout_(layout),
+      pool_(pool),
+      pack_pixels_(GetPixelPacker(output_format)),
+      channels_per_pixel_(ChannelCount(output_format)),
+      pixels_per_packet_(kPacketBytes / channels_per_pixel_),
+      packets_per_frame_((layout.pixel_count() + pixels_per_packet_ - 1) /
+                         pixels_per_packet_),
+      arena_(kArenaBytes),
+      frame_pool_(layout.pixel_count() * sizeof(Rgba8), kFramesInFlight),
+      packet_pool_(kPacketBytes, packets_per_frame_ * kFramesInFlight),
+      tile_scratch_(new Rgba8[kTilePixels *
+                              (pool != nullptr ? pool->thread_count() : 1)]) {
+  for (FrameSlot& slot : slots_) {
+    slot.packets.reserve(packets_per_frame_);
+  }
+}
+
+uint32_t RenderPipeline::AddLayer(LayerConfig config) {
+  if (config.renderer.render == nullptr || layers_.full()) return 0;
+  Layer layer;
+  layer.id = next_layer_id_++;
+  const size_t state_size =
+      config.state_bytes_per_pixel * layout_.pixel_count();
+  if (state_size > 0) {
+    layer.state_storage.reset(new uint8_t[2 * state_size]());
+    layer.previous_state = layer.state_storage.get();
+    layer.state = layer.state_storage.get() + state_size;
+  }
+  layer.config = std::move(config);
+  const uint32_t id = layer.id;
+  layers_.push_back(std::move(layer));
+  return id;
+}
+
+bool RenderPipeline::RemoveLayer(uint32_t layer_id) {
+  for (size_t i = 0; i < layers_.size(); ++i) {
+    if (layers_[i].id == layer_id) {
+      layers_.erase(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RenderPipeline::ScheduleCue(const Cue& cue) {
+  // Keep the queue sorted by time; cues at equal times run in the order
+  // they were scheduled.
+  size_t index = cues_.size();
+  while (index > 0 && cues_[index - 1].time > cue.time) --index;
+  return cues_.insert(index, cue);
+}
+
+RenderPipeline::Layer* RenderPipeline::FindLayer(uint32_t layer_id) {
+  for (Layer& layer : layers_) {
+    if (layer.id == layer_id) return &layer;
+  }
+  return nullptr;
+}
+
+void RenderPipeline::ApplyDueCues(double time) {
+  while (!cues_.empty() && cues_[0].time <= time) {
+    const Cue& cue = cues_[0];
+    if (Layer* layer = FindLayer(cue.layer_id)) {
+      switch (cue.action) {
+        case CueAction::kEnableLayer:
+          layer->config.enabled = true;
+          break;
+        case CueAction::kDisableLayer:
+          layer->config.enabled = false;
+          break;
+        case CueAction::kSetOpacity:
+          layer->config.opacity = cue.opacity;
+          break;
+      }
+    }
+    cues_.erase(0);
+  }
+}
+
+void RenderPipeline::AdvancePaletteTransitions(double time) {
+  const double elapsed = have_last_frame_time_ ? time - last_frame_time_ : 0.0;
+  last_frame_time_ = time;
+  have_last_frame_time_ = true;
+  // Disabled layers keep fading too, so they show the right colors when
+  // they come back.
+  for (Layer& layer : layers_) {
+    if (layer.config.palette_transition != nullptr && elapsed > 0.0) {
+      layer.config.palette_transition->Advance(elapsed);
+    }
+  }
+}
+
+RenderPipeline::FrameSlot* RenderPipeline::AcquireSlot() {
+  std::lock_guard<std::mutex> lock(slots_mutex_);
+  for (FrameSlot& slot : slots_) {
+    if (!slot.in_use) {
+      slot.in_use = true;
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+const Frame* RenderPipeline::RenderFrame(double time) {
+  ScopedNoHeapAllocation no_heap;
+  task_allocations_.store(0, std::memory_order_relaxed);
+  arena_.Reset();
+  ApplyDueCues(time);
+  AdvancePaletteTransitions(time);
+
+  FrameSlot* slot = AcquireSlot();
+  if (slot == nullptr) {
+    ++stats_.frames_dropped;
+    stats_.heap_allocations += no_heap.allocations();
+    return nullptr;
+  }
+
+  // One pool buffer exists per slot, so this cannot fail.
+  slot->pixel_buffer = frame_pool_.Acquire();
+  assert(slot->pixel_buffer != nullptr);
+  Rgba8* pixels = reinterpret_cast<Rgba8*>(slot->pixel_buffer);
+
+  // Frame-wide effect work runs here, once, before the tiles fan out.
+  active_layers_.clear();
+  for (Layer& layer : layers_) {
+    const LayerConfig& config = layer.config;
+    if (!config.enabled || config.opacity == 0) continue;
+    std::swap(layer.previous_state, layer.state);
+    const PaletteLut* palette = config.palette_transition != nullptr
+                                    ? &config.palette_transition->current()
+                                    : config.palette.get();
+    const EffectContext context{&layout_,
+                                time,
+                                next_frame_index_,
+                                palette,
+                                config.params.data(),
+                                &arena_,
+                                layer.previous_state,
+                                layer.state,
+                                config.seed,
+                                config.user_data};
+    const void* prepared = config.renderer.prepare(context);
+    if (prepared == nullptr) continue;
+    active_layers_.push_back(ActiveLayer{context, config.renderer.render,
+                                         prepared, config.opacity});
+  }
+
+  const auto render_tile = [this, pixels](size_t tile, size_t worker) {
+    ScopedNoHeapAllocation worker_no_heap;
+    RenderTile(tile, worker, pixels);
+    CountTaskAllocations(worker, worker_no_heap, &task_allocations_);
+  };
+  const size_t tiles = TileCount(layout_);
+  if (pool_ != nullptr) {
+    pool_->Run(tiles, render_tile);
+  } else {
+    for (size_t tile = 0; tile < tiles; ++tile) render_tile(tile, 0);
+  }
+
+  Packetize(pixels, slot);
+  slot->frame.index = next_frame_index_++;
+  slot->frame.time = time;
+  slot->frame.pixels = pixels;
+
+  ++stats_.frames_rendered;
+  stats_.arena_high_water = arena_.high_water();
+  // Run() returning orders every task's count before this load.
+  stats_.heap_allocations +=
+      no_heap.allocations() + task_allocations_.load(std::memory_order_relaxed);
+  return &slot->frame;
+}
+
+void RenderPipeline::RenderTile(size_t tile_index, size_t worker,
+                                Rgba8* pixels) {
+  const Tile tile = GetTile(layout_, tile_index);
+  Rgba8* frame_tile = pixels + tile.begin;
+  Rgba8* layer_tile = tile_scratch_.get() + worker * kTilePixels;
+  std::memset(frame_tile, 0, tile.size() * sizeof(Rgba8));
+  for (const ActiveLayer& layer : active_layers_) {
+    layer.render(layer.prepared, layer.context, tile,
+                 reinterpret_cast<uint8_t*>(layer_tile));
+    CompositeOver(layer_tile, layer.opacity, frame_tile, tile.size());
+  }
+}
+
+void RenderPipeline::Packetize(const Rgba8* pixels, FrameSlot* slot) {
+  slot->packets.clear();
+  const size_t count = layout_.pixel_count();
+  for (size_t first = 0; first < count; first += pixels_per_packet_) {
+    const size_t run = count - first < pixels_per_packet_ ? count - first
+                                                          : pixels_per_packet_;
+    uint8_t* data = packet_pool_.Acquire();
+    assert(data != nullptr);
+    // Within the capacity reserved at construction.
+    slot->packets.push_back(
+        Packet{static_cast<uint16_t>(slot->packets.size()),
+               static_cast<uint16_t>(run * channels_per_pixel_), data});
+  }
+  slot->frame.packets = slot->packets.data();
+  slot->frame.packet_count = slot->packets.size();
+
+  // Pixels are composited over black, so premultiplied values are the
+  // final channel levels. Each task packs about a tile's worth of pixels;
+  // a task per packet would spend more on dispatch than on packing.
+  const size_t packet_count = slot->packets.size();
+  const size_t run = pixels_per_packet_ < kTilePixels
+                         ? kTilePixels / pixels_per_packet_
+                         : 1;
+  const auto pack = [this, pixels, slot, packet_count, run](size_t task,
+                                                             size_t worker) {
+    ScopedNoHeapAllocation worker_no_heap;
+    const size_t first = task * run;
+    const size_t end = packet_count - first < run ? packet_count : first + run;
+    for (size_t index = first; index < end; ++index) {
+      const Packet& packet = slot->packets[index];
+      pack_pixels_(pixels + index * pixels_per_packet_,
+                   packet.size / channels_per_pixel_, packet.data);
+    }
+    CountTaskAllocations(worker, worker_no_heap, &task_allocations_);
+  };
+  const size_t tasks = (packet_count + run - 1) / run;
+  if (pool_ != nullptr) {
+    pool_->Run(tasks, pack);
+  } else {
+    for (size_t task = 0; task < tasks; ++task) pack(task, 0);
+  }
+}
+
+void RenderPipeline::ReleaseFrame(const Frame* frame) {
+  std::lock_guard<std::mutex> lock(slots_mutex_);
+  for (FrameSlot& slot : slots_) {
+    if (&slot.frame != frame) continue;
+    assert(slot.in_use);
+    for (const Packet& packet : slot.packets) {
+      packet_pool_.Release(packet.data);
+    }
+    slot.packets.clear();
+    frame_pool_.Release(slot.pixel_buffer);
+    slot.pixel_buffer = nullptr;
+    slot.frame = Frame();
+    slot.in_use = false;
+    return;
+  }
+  assert(false && "frame does not belong to this pipeline");
+}
+
+}  // namespace blinky
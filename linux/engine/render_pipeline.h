@@ -0,0 +1,199 @@
+#ifndef BLINKY_ENGINE_RENDER_PIPELINE_H_
+#define BLINKY_ENGINE_RENDER_PIPELINE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "engine/buffer_pool.h"
+#include "engine/color.h"
+#include "engine/effect.h"
+#include "engine/fixed_vector.h"
+#include "engine/frame_arena.h"
+#include "engine/palette.h"
+#include "engine/pixel_format.h"
+#include "engine/worker_pool.h"
+
+namespace blinky {
+
+struct LayerConfig {
+  // Must write PixelFormat::kRgba pixels.
+  EffectRenderer renderer;
+  std::shared_ptr<const PaletteLut> palette;
+  std::array<float, kMaxLayerParams> params = {};
+  // Size of the layer's persistent EffectContext::state, per pixel.
+  size_t state_bytes_per_pixel = 0;
+  uint64_t seed = 0;
+  // Passed through as EffectContext::user_data; must outlive the layer.
+  const void* user_data = nullptr;
+  // Optional. The layer then renders with the transition's current() table
+  // instead of |palette|, and every frame advances the transition by the
+  // time since the previous frame. Give each layer its own transition; it
+  // must outlive the layer, and Start() it on the thread that renders.
+  PaletteTransition* palette_transition = nullptr;
+  uint8_t opacity = 255;
+  bool enabled = true;
+};
+
+enum class CueAction {
+  kEnableLayer,
+  kDisableLayer,
+  kSetOpacity,
+};
+
+// A layer change that takes effect on the first frame at or after |time|.
+struct Cue {
+  double time;
+  uint32_t layer_id;
+  CueAction action;
+  uint8_t opacity = 255;
+};
+
+// One output packet holding at most one DMX universe of channel data.
+struct Packet {
+  uint16_t universe;
+  uint16_t size;
+  uint8_t* data;
+};
+
+// A rendered frame. Owned by the pipeline until passed to ReleaseFrame().
+struct Frame {
+  uint64_t index = 0;
+  double time = 0.0;
+  const Rgba8* pixels = nullptr;
+  const Packet* packets = nullptr;
+  size_t packet_count = 0;
+};
+
+struct PipelineStats {
+  uint64_t frames_rendered = 0;
+  // Frames skipped because output still held every frame buffer.
+  uint64_t frames_dropped = 0;
+  size_t arena_high_water = 0;
+  // Heap allocations made inside RenderFrame(), on the calling thread or by
+  // its tasks on the pool. Allocations by other pipelines rendering at the
+  // same time are not included. Always zero unless the engine is built with
+  // BLINKY_ENGINE_ALLOC_GUARD.
+  size_t heap_allocations = 0;
+};
+
+// Composites layers into frames and slices them into output packets.
+//
+// Frames are rendered tile by tile: each tile runs every layer into a small
+// per-worker buffer and composites it straight into the frame, so layer
+// output never leaves the cache. With a WorkerPool, tiles and packets are
+// spread across its threads; output is bit-identical for any thread count.
+//
+// Everything the frame loop needs is sized and allocated at construction or
+// when layers are added; RenderFrame() runs without heap allocation. Layer
+// and cue configuration must happen on the thread that calls RenderFrame();
+// ReleaseFrame() may be called from any thread.
+class RenderPipeline {
+ public:
+  static constexpr size_t kMaxLayers = 16;
+  static constexpr size_t kMaxCues = 256;
+  static constexpr size_t kFramesInFlight = 3;
+  static constexpr size_t kPacketBytes = 512;
+
+  // Packets carry pixels in |output_format|; a pixel never straddles two
+  // packets. |pool|, if given, must outlive the pipeline and may be shared
+  // with other pipelines rendering from the same thread.
+  explicit RenderPipeline(const Layout& layout,
+                          PixelFormat output_format = PixelFormat::kRgb,
+                          WorkerPool* pool = nullptr);
+
+  RenderPipeline(const RenderPipeline&) = delete;
+  RenderPipeline& operator=(const RenderPipeline&) = delete;
+
+  const Layout& layout() const { return layout_; }
+  size_t pixels_per_packet() const { return pixels_per_packet_; }
+  size_t packets_per_frame() const { return packets_per_frame_; }
+
+  // The memory all Packet::data points into, for output transports that
+  // register it with the kernel once instead of mapping it per send.
+  const uint8_t* packet_memory() const { return packet_pool_.data(); }
+  size_t packet_memory_size() const { return packet_pool_.data_size(); }
+
+  // Adds a layer on top of the others. Returns its id, or 0 if the layer
+  // stack is full or |config| has no renderer.
+  uint32_t AddLayer(LayerConfig config);
+  bool RemoveLayer(uint32_t layer_id);
+
+  // Queues |cue|. Returns false if the cue queue is full.
+  bool ScheduleCue(const Cue& cue);
+
+  // Renders the frame at |time|. Returns null, counting a dropped frame, if
+  // output still holds every frame buffer.
+  const Frame* RenderFrame(double time);
+
+  // Hands |frame| back once output has finished with it.
+  void ReleaseFrame(const Frame* frame);
+
+  const PipelineStats& stats() const { return stats_; }
+
+ private:
+  struct Layer {
+    uint32_t id = 0;
+    LayerConfig config;
+    // Both state buffers in one block; the pointers swap every frame.
+    std::unique_ptr<uint8_t[]> state_storage;
+    uint8_t* previous_state = nullptr;
+    uint8_t* state = nullptr;
+  };
+
+  // A layer taking part in the current frame.
+  struct ActiveLayer {
+    EffectContext context;
+    EffectRenderFn render;
+    const void* prepared;
+    uint8_t opacity;
+  };
+
+  struct FrameSlot {
+    Frame frame;
+    uint8_t* pixel_buffer = nullptr;
+    std::vector<Packet> packets;
+    bool in_use = false;
+  };
+
+  Layer* FindLayer(uint32_t layer_id);
+  void ApplyDueCues(double time);
+  void AdvancePaletteTransitions(double time);
+  FrameSlot* AcquireSlot();
+  void RenderTile(size_t tile_index, size_t worker, Rgba8* pixels);
+  void Packetize(const Rgba8* pixels, FrameSlot* slot);
+
+  Layout layout_;
+  WorkerPool* pool_;
+  PackPixelsFn pack_pixels_;
+  size_t channels_per_pixel_;
+  size_t pixels_per_packet_;
+  size_t packets_per_frame_;
+  FrameArena arena_;
+  BufferPool frame_pool_;
+  BufferPool packet_pool_;
+  // kTilePixels of layer output for each worker.
+  std::unique_ptr<Rgba8[]> tile_scratch_;
+  FixedVector<Layer, kMaxLayers> layers_;
+  FixedVector<ActiveLayer, kMaxLayers> active_layers_;
+  FixedVector<Cue, kMaxCues> cues_;
+  std::mutex slots_mutex_;
+  std::array<FrameSlot, kFramesInFlight> slots_;
+  uint32_t next_layer_id_ = 1;
+  uint64_t next_frame_index_ = 0;
+  // Time of the previous RenderFrame() call, for advancing transitions.
+  double last_frame_time_ = 0.0;
+  bool have_last_frame_time_ = false;
+  PipelineStats stats_;
+  // Allocations made by pool threads during the current RenderFrame(). Kept
+  // per pipeline so concurrent pipelines don't see each other's.
+  std::atomic<size_t> task_allocations_{0};
+};
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_RENDER_PIPELINE_H_
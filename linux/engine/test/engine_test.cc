@@ -0,0 +1,705 @@
+// Unit tests for the native lighting engine.
+//
+// Plain asserts keep the engine free of test-framework dependencies; each
+// test is a function registered in kTests and run by main().
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/alloc_guard.h"
+#include "engine/buffer_pool.h"
+#include "engine/color.h"
+#include "engine/effect_registry.h"
+#include "engine/engine_ffi.h"
+#include "engine/fixed_vector.h"
+#include "engine/frame_arena.h"
+#ifdef BLINKY_ENGINE_IO_URING
+#include "engine/io_uring_transport.h"
+#endif
+#include "engine/output_transport.h"
+#include "engine/palette.h"
+#include "engine/pixel_format.h"
+#include "engine/pixel_protocol.h"
+#include "engine/render_pipeline.h"
+#include "engine/worker_pool.h"
+
+namespace blinky {
+namespace {
+
+#define EXPECT(condition)                                              \
+  do {                                                                 \
+    if (!(condition)) {                                                \
+      std::fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, \
+                   #condition);                                        \
+      ++g_failures;                                                    \
+    }                                                                  \
+  } while (0)
+
+int g_failures = 0;
+
+void TestParseHexColor() {
+  uint32_t rgb = 0;
+  EXPECT(ParseHexColor("#7C6BFF", &rgb) && rgb == 0x7C6BFF);
+  EXPECT(ParseHexColor(" 7c6bff ", &rgb) && rgb == 0x7C6BFF);
+  EXPECT(!ParseHexColor("#7C6BF", &rgb));
+  EXPECT(!ParseHexColor("#7C6BFG", &rgb));
+  EXPECT(!ParseHexColor("", &rgb));
+}
+
+void TestCompileGradient() {
+  const GradientStop stops[] = {{0.0f, "#000000"}, {1.0f, "#FF0000", 128}};
+  PaletteLut lut(PaletteLut::kSmallSize);
+  EXPECT(CompileGradient(stops, 2, &lut));
+  EXPECT(lut.data()[0] == (Rgba8{0, 0, 0, 255}));
+  // The last entry is red at half opacity, premultiplied.
+  EXPECT(lut.data()[255] == (Rgba8{128, 0, 0, 128}));
+  EXPECT(lut.Sample(0xFFFF) == lut.data()[255]);
+
+  const GradientStop unsorted[] = {{0.5f, "#000000"}, {0.2f, "#FFFFFF"}};
+  EXPECT(!CompileGradient(unsorted, 2, &lut));
+  const GradientStop bad_hex[] = {{0.0f, "#12345"}};
+  EXPECT(!CompileGradient(bad_hex, 1, &lut));
+}
+
+void TestHardStop() {
+  PaletteLibrary library;
+  auto candy = library.Get("Candy Cane", PaletteLut::kLargeSize);
+  EXPECT(candy != nullptr && candy->size() == PaletteLut::kLargeSize);
+  EXPECT(candy->Sample(0x7FFF) == (Rgba8{255, 0, 0, 255}));
+  EXPECT(candy->Sample(0x8000) == (Rgba8{255, 255, 255, 255}));
+}
+
+void TestLibrarySharesTables() {
+  PaletteLibrary library;
+  for (const BuiltinPalette& builtin : BuiltinPalettes()) {
+    EXPECT(library.Get(builtin.name) != nullptr);
+  }
+  EXPECT(library.Get("Fire") == library.Get("Fire"));
+  EXPECT(library.Get("Fire") != library.Get("Fire", PaletteLut::kLargeSize));
+  EXPECT(library.Get("No Such Palette") == nullptr);
+  EXPECT(library.Get("Fire", 100) == nullptr);
+  EXPECT(library.Get("Fire", 0) == nullptr);
+
+  auto before = library.Get("Fire");
+  EXPECT(library.Define("Fire", {{0.0f, "#FFFFFF"}}));
+  EXPECT(library.Get("Fire") != before);
+  EXPECT(!library.Define("Broken", {{0.0f, "nope"}}));
+}
+
+void TestLibraryCopiesStops() {
+  PaletteLibrary library;
+  {
+    // Stops as typed into HexInputField, gone before any table is built.
+    std::string from = "#FF0000";
+    std::string to = " 0000ff ";
+    EXPECT(library.Define("User", {{0.0f, from.c_str()}, {1.0f, to.c_str()}}));
+    from.assign(from.size(), 'x');
+    to.assign(to.size(), 'x');
+  }
+  for (size_t size : {PaletteLut::kSmallSize, PaletteLut::kLargeSize}) {
+    auto lut = library.Get("User", size);
+    EXPECT(lut != nullptr && lut->size() == size);
+    EXPECT(lut->data()[0] == (Rgba8{255, 0, 0, 255}));
+    EXPECT(lut->data()[size - 1] == (Rgba8{0, 0, 255, 255}));
+  }
+}
+
+void TestTransition() {
+  PaletteLibrary library;
+  library.Define("Black", {{0.0f, "#000000"}});
+  library.Define("White", {{0.0f, "#FFFFFF"}});
+  PaletteTransition transition(library.Get("Black"));
+  EXPECT(transition.current().Sample(0).r == 0);
+
+  transition.Start(library.Get("White"), 1.0);
+  transition.Advance(0.5);
+  EXPECT(transition.active());
+  EXPECT(transition.current().Sample(0).r == 127);
+
+  transition.Advance(0.5);
+  EXPECT(!transition.active());
+  EXPECT(&transition.current() == library.Get("White").get());
+}
+
+void TestSamplePalette() {
+  PaletteLibrary library;
+  auto fire = library.Get("Fire");
+  const uint16_t phases[] = {0, 0x4000, 0xFFFF};
+  Rgba8 out[3];
+  SamplePalette(*fire, phases, 3, out);
+  EXPECT(out[0] == fire->data()[0]);
+  EXPECT(out[1] == fire->data()[64]);
+  EXPECT(out[2] == fire->data()[255]);
+}
+
+void TestFrameArena() {
+  FrameArena arena(256);
+  void* first = arena.Allocate(10, 1);
+  uint32_t* aligned = arena.AllocateArray<uint32_t>(4);
+  EXPECT(first != nullptr && aligned != nullptr);
+  EXPECT(reinterpret_cast<uintptr_t>(aligned) % alignof(uint32_t) == 0);
+  EXPECT(arena.Allocate(1024) == nullptr);
+  EXPECT(arena.failed_allocations() == 1);
+
+  arena.Reset();
+  EXPECT(arena.used() == 0);
+  EXPECT(arena.Allocate(10, 1) == first);
+}
+
+void TestBufferPool() {
+  BufferPool pool(100, 2);
+  uint8_t* a = pool.Acquire();
+  uint8_t* b = pool.Acquire();
+  EXPECT(a != nullptr && b != nullptr && a != b);
+  EXPECT(reinterpret_cast<uintptr_t>(a) % BufferPool::kAlignment == 0);
+  EXPECT(pool.Acquire() == nullptr);
+  pool.Release(a);
+  EXPECT(pool.available() == 1);
+  EXPECT(pool.Acquire() == a);
+}
+
+void TestFixedVector() {
+  FixedVector<std::shared_ptr<int>, 3> items;
+  EXPECT(items.push_back(std::make_shared<int>(1)));
+  EXPECT(items.push_back(std::make_shared<int>(3)));
+  EXPECT(items.insert(1, std::make_shared<int>(2)));
+  EXPECT(!items.push_back(std::make_shared<int>(4)));
+  EXPECT(*items[0] == 1 && *items[1] == 2 && *items[2] == 3);
+  items.erase(0);
+  EXPECT(items.size() == 2 && *items[0] == 2);
+}
+
+void TestAllocationGuard() {
+  if (!AllocationGuardEnabled()) return;
+  ScopedNoHeapAllocation guard(/*assert_on_exit=*/false);
+  std::string* leak = new std::string(64, 'x');
+  EXPECT(guard.allocations() >= 1);
+  delete leak;
+}
+
+// Test effects need no per-frame setup and shade whole tiles directly.
+const void* PrepareNothing(const EffectContext& context) {
+  return &context;
+}
+
+void RenderSolidTile(const void*, const EffectContext&, const Tile& tile,
+                     uint8_t* out) {
+  const Rgba8 color = Premultiply(0xFF8000, 255);
+  for (size_t i = 0; i < tile.size(); ++i, out += 4) {
+    RgbaPixels::Store(color, out);
+  }
+}
+
+void RenderPaletteRampTile(const void*, const EffectContext& context,
+                           const Tile& tile, uint8_t* out) {
+  const Rgba8* entries = context.palette->data();
+  for (size_t i = tile.begin; i < tile.end; ++i, out += 4) {
+    RgbaPixels::Store(entries[(i + context.frame_index) & 0xFF], out);
+  }
+}
+
+void RenderAllocatingTile(const void*, const EffectContext&, const Tile& tile,
+                          uint8_t* out) {
+  std::vector<uint8_t> copy(tile.size() * 4);
+  for (size_t i = 0; i < copy.size(); ++i) out[i] = copy[i];
+}
+
+constexpr EffectRenderer kSolid{PrepareNothing, RenderSolidTile};
+constexpr EffectRenderer kPaletteRamp{PrepareNothing, RenderPaletteRampTile};
+constexpr EffectRenderer kAllocating{PrepareNothing, RenderAllocatingTile};
+
+void TestPipelineComposites() {
+  RenderPipeline pipeline(Layout{10, 20});
+  LayerConfig base;
+  base.renderer = kSolid;
+  const uint32_t base_id = pipeline.AddLayer(base);
+  EXPECT(base_id != 0);
+
+  const Frame* frame = pipeline.RenderFrame(0.0);
+  EXPECT(frame != nullptr);
+  EXPECT(frame->pixels[0] == (Rgba8{255, 128, 0, 255}));
+  // 200 pixels at 170 per universe.
+  EXPECT(frame->packet_count == 2);
+  EXPECT(frame->packets[0].size == 510 && frame->packets[1].size == 90);
+  EXPECT(frame->packets[1].data[0] == 255 && frame->packets[1].data[1] == 128);
+  pipeline.ReleaseFrame(frame);
+
+  EXPECT(pipeline.ScheduleCue(Cue{1.0, base_id, CueAction::kSetOpacity, 0}));
+  frame = pipeline.RenderFrame(1.0);
+  EXPECT(frame->pixels[0] == (Rgba8{0, 0, 0, 0}));
+  pipeline.ReleaseFrame(frame);
+}
+
+void TestPipelineBackpressure() {
+  RenderPipeline pipeline(Layout{4, 4});
+  LayerConfig config;
+  config.renderer = kSolid;
+  pipeline.AddLayer(config);
+  const Frame* held[RenderPipeline::kFramesInFlight];
+  for (const Frame*& frame : held) frame = pipeline.RenderFrame(0.0);
+  EXPECT(pipeline.RenderFrame(0.0) == nullptr);
+  EXPECT(pipeline.stats().frames_dropped == 1);
+  pipeline.ReleaseFrame(held[1]);
+  EXPECT(pipeline.RenderFrame(0.0) != nullptr);
+}
+
+void TestPipelineSteadyStateDoesNotAllocate() {
+  PaletteLibrary library;
+  RenderPipeline pipeline(Layout{64, 32});
+  LayerConfig ramp;
+  ramp.renderer = kPaletteRamp;
+  ramp.palette = library.Get("Ocean Waves");
+  const uint32_t ramp_id = pipeline.AddLayer(ramp);
+  LayerConfig overlay;
+  overlay.renderer = kSolid;
+  overlay.opacity = 64;
+  pipeline.AddLayer(overlay);
+  for (int i = 0; i < 8; ++i) {
+    pipeline.ScheduleCue(Cue{i * 0.1, ramp_id, i % 2 == 0
+                                                   ? CueAction::kDisableLayer
+                                                   : CueAction::kEnableLayer});
+  }
+
+  for (int i = 0; i < 120; ++i) {
+    const Frame* frame = pipeline.RenderFrame(i / 60.0);
+    EXPECT(frame != nullptr);
+    pipeline.ReleaseFrame(frame);
+  }
+  EXPECT(pipeline.stats().frames_rendered == 120);
+  EXPECT(pipeline.stats().heap_allocations == 0);
+}
+
+void TestPipelineReportsAllocations() {
+  if (!AllocationGuardEnabled()) return;
+  RenderPipeline pipeline(Layout{8, 8});
+  LayerConfig config;
+  config.renderer = kAllocating;
+  pipeline.AddLayer(config);
+#ifdef NDEBUG
+  pipeline.ReleaseFrame(pipeline.RenderFrame(0.0));
+  EXPECT(pipeline.stats().heap_allocations > 0);
+
+  // Tiles rendered on pool threads are charged to their own pipeline only,
+  // once each, while a clean pipeline renders alongside.
+  WorkerPool pool(4);
+  const Layout layout{128, 128};
+  RenderPipeline pooled(layout, PixelFormat::kRgb, &pool);
+  pooled.AddLayer(config);
+  RenderPipeline clean(layout);
+  LayerConfig solid;
+  solid.renderer = kSolid;
+  clean.AddLayer(solid);
+  std::thread other([&clean] {
+    for (int i = 0; i < 50; ++i) clean.ReleaseFrame(clean.RenderFrame(0.0));
+  });
+  for (int i = 0; i < 50; ++i) pooled.ReleaseFrame(pooled.RenderFrame(0.0));
+  other.join();
+  EXPECT(pooled.stats().heap_allocations == 50 * TileCount(layout));
+  EXPECT(clean.stats().heap_allocations == 0);
+#endif
+}
+
+void TestPipelineRendersPaletteTransition() {
+  PaletteLibrary library;
+  library.Define("Black", {{0.0f, "#000000"}});
+  library.Define("White", {{0.0f, "#FFFFFF"}});
+  PaletteTransition transition(library.Get("Black"));
+  RenderPipeline pipeline(Layout{8, 1});
+  LayerConfig config;
+  config.renderer = kPaletteRamp;
+  config.palette = library.Get("Black");
+  config.palette_transition = &transition;
+  pipeline.AddLayer(config);
+
+  const uint8_t expected_red[] = {0, 127, 255, 255, 255};
+  for (int i = 0; i < 5; ++i) {
+    if (i == 1) transition.Start(library.Get("White"), 1.0);
+    const Frame* frame = pipeline.RenderFrame(i * 0.5);
+    EXPECT(frame->pixels[0].r == expected_red[i]);
+    pipeline.ReleaseFrame(frame);
+  }
+  EXPECT(!transition.active());
+  EXPECT(pipeline.stats().heap_allocations == 0);
+}
+
+void TestPipelineOutputFormat() {
+  RenderPipeline pipeline(Layout{200, 1}, PixelFormat::kRgbw);
+  LayerConfig config;
+  config.renderer = kSolid;
+  pipeline.AddLayer(config);
+  const Frame* frame = pipeline.RenderFrame(0.0);
+  EXPECT(pipeline.pixels_per_packet() == 128);
+  EXPECT(frame->packet_count == 2 && frame->packets[1].size == 72 * 4);
+  // 0xFF8000 moves its common 0x00 to white.
+  EXPECT(frame->packets[0].data[0] == 255 && frame->packets[0].data[1] == 128 &&
+         frame->packets[0].data[2] == 0 && frame->packets[0].data[3] == 0);
+  pipeline.ReleaseFrame(frame);
+}
+
+void TestPixelFormats() {
+  const Rgba8 color{200, 100, 50, 255};
+  uint8_t out[4] = {};
+  GrbPixels::Store(color, out);
+  EXPECT(out[0] == 100 && out[1] == 200 && out[2] == 50);
+  RgbwPixels::Store(color, out);
+  EXPECT(out[0] == 150 && out[1] == 50 && out[2] == 0 && out[3] == 50);
+}
+
+// The effect names the app shows, in the order it lists them.
+void TestRegistryMatchesApp() {
+  const char* const kAppEffects[] = {
+      "Rainbow Swirl", "Color Mood Blobs", "Police Lights", "Strobe White",
+      "Fire",          "Ocean Waves",      "Pulsing Purple", "Twinkle",
+      "Warm Sunset",   "Ice Blue",         "Forest Green",  "Candy Cane",
+      "Matrix Rain",   "Heartbeat",        "Northern Lights", "Lava Lamp",
+  };
+  static_assert(sizeof(kAppEffects) / sizeof(kAppEffects[0]) == kEffectCount,
+                "registry and app disagree on the effect count");
+  static_assert(FindEffect("Fire")->id == EffectId::kFire, "");
+  static_assert(FindEffect("Disco") == nullptr, "");
+  for (size_t i = 0; i < kEffectCount; ++i) {
+    EXPECT(std::string(kEffects[i].name) == kAppEffects[i]);
+    EXPECT(blinky_effect_find(kAppEffects[i]) == static_cast<int32_t>(i));
+    for (size_t p = 0; p < kEffects[i].param_count; ++p) {
+      const EffectParam& param = kEffects[i].params[p];
+      EXPECT(param.min <= param.default_value &&
+             param.default_value <= param.max);
+    }
+  }
+  EXPECT(blinky_effect_name(kEffectCount) == nullptr);
+  EXPECT(blinky_effect_category(static_cast<uint32_t>(EffectId::kCandyCane)) ==
+         static_cast<uint32_t>(EffectCategory::kParty));
+}
+
+void TestEffectsPackInEveryFormat() {
+  PaletteLibrary library;
+  const Layout layout{24, 16};
+  for (const EffectInfo& info : kEffects) {
+    const LayerConfig config = MakeEffectLayer(info.id, &library);
+    EXPECT(config.renderer.render == GetEffectRenderer(info.id).render);
+    EXPECT((info.palette == nullptr) == (config.palette == nullptr));
+
+    // Render the same layer for RGB and GRB strips and compare the packed
+    // channel order.
+    RenderPipeline rgb(layout, PixelFormat::kRgb);
+    RenderPipeline grb(layout, PixelFormat::kGrb);
+    rgb.AddLayer(config);
+    grb.AddLayer(config);
+    const Frame* rgb_frame = rgb.RenderFrame(2.5);
+    const Frame* grb_frame = grb.RenderFrame(2.5);
+    bool same = rgb_frame->packet_count == grb_frame->packet_count;
+    for (size_t p = 0; same && p < rgb_frame->packet_count; ++p) {
+      const Packet& a = rgb_frame->packets[p];
+      const Packet& b = grb_frame->packets[p];
+      same = a.size == b.size;
+      for (size_t i = 0; same && i < a.size; i += 3) {
+        same = b.data[i] == a.data[i + 1] && b.data[i + 1] == a.data[i] &&
+               b.data[i + 2] == a.data[i + 2];
+      }
+    }
+    if (!same) std::fprintf(stderr, "format mismatch in %s\n", info.name);
+    EXPECT(same);
+    rgb.ReleaseFrame(rgb_frame);
+    grb.ReleaseFrame(grb_frame);
+  }
+}
+
+void TestEffectLayersDoNotAllocate() {
+  PaletteLibrary library;
+  RenderPipeline pipeline(Layout{48, 24});
+  for (const EffectInfo& info : kEffects) {
+    LayerConfig config = MakeEffectLayer(info.id, &library);
+    config.opacity = 128;
+    EXPECT(pipeline.AddLayer(std::move(config)) != 0);
+  }
+  for (int i = 0; i < 30; ++i) {
+    pipeline.ReleaseFrame(pipeline.RenderFrame(i / 30.0));
+  }
+  EXPECT(pipeline.stats().heap_allocations == 0);
+}
+
+// A layer missing the palette or state its effect needs is skipped rather
+// than rendered.
+void TestEffectLayersMissingInputsAreSkipped() {
+  PaletteLibrary library;
+  RenderPipeline pipeline(Layout{16, 8});
+  LayerConfig base;
+  base.renderer = kSolid;
+  pipeline.AddLayer(base);
+  LayerConfig ocean = MakeEffectLayer(EffectId::kOceanWaves, &library);
+  ocean.palette.reset();
+  pipeline.AddLayer(std::move(ocean));
+  LayerConfig fire = MakeEffectLayer(EffectId::kFire, &library);
+  fire.state_bytes_per_pixel = 0;
+  pipeline.AddLayer(std::move(fire));
+  LayerConfig twinkle = MakeEffectLayer(EffectId::kTwinkle, &library);
+  twinkle.state_bytes_per_pixel = 0;
+  pipeline.AddLayer(std::move(twinkle));
+
+  const Frame* frame = pipeline.RenderFrame(1.0);
+  EXPECT(frame != nullptr);
+  bool untouched = true;
+  for (size_t i = 0; i < 16 * 8; ++i) {
+    untouched = untouched && frame->pixels[i] == (Rgba8{255, 128, 0, 255});
+  }
+  EXPECT(untouched);
+  pipeline.ReleaseFrame(frame);
+}
+
+void TestWorkerPoolRunsEveryTaskOnce() {
+  for (size_t threads : {1, 3, 8}) {
+    WorkerPool pool(threads);
+    std::vector<std::atomic<int>> runs(1000);
+    for (int batch = 0; batch < 20; ++batch) {
+      pool.Run(runs.size(), [&](size_t task, size_t worker) {
+        EXPECT(worker < threads);
+        runs[task].fetch_add(1);
+      });
+    }
+    bool all_twenty = true;
+    for (const std::atomic<int>& count : runs) {
+      all_twenty = all_twenty && count.load() == 20;
+    }
+    EXPECT(all_twenty);
+  }
+}
+
+// Renders every effect as one layer stack for a few frames and returns the
+// concatenated frames.
+std::vector<Rgba8> RenderAllEffects(const Layout& layout, WorkerPool* pool) {
+  PaletteLibrary library;
+  RenderPipeline pipeline(layout, PixelFormat::kRgb, pool);
+  for (const EffectInfo& info : kEffects) {
+    LayerConfig config = MakeEffectLayer(info.id, &library);
+    config.opacity = 96;
+    pipeline.AddLayer(std::move(config));
+  }
+  std::vector<Rgba8> frames;
+  for (int i = 0; i < 12; ++i) {
+    const Frame* frame = pipeline.RenderFrame(i / 60.0);
+    frames.insert(frames.end(), frame->pixels,
+                  frame->pixels + layout.pixel_count());
+    pipeline.ReleaseFrame(frame);
+  }
+  EXPECT(pipeline.stats().heap_allocations == 0);
+  return frames;
+}
+
+void TestTiledRenderIsThreadCountInvariant() {
+  // Several tiles, with a ragged last tile and rows spanning tile edges.
+  const Layout layout{173, 61};
+  const std::vector<Rgba8> serial = RenderAllEffects(layout, nullptr);
+  for (size_t threads : {1, 2, 5, 8}) {
+    WorkerPool pool(threads);
+    const std::vector<Rgba8> parallel = RenderAllEffects(layout, &pool);
+    EXPECT(parallel.size() == serial.size() &&
+           std::equal(parallel.begin(), parallel.end(), serial.begin()));
+  }
+}
+
+void TestPixelProtocol() {
+  const Rgba8 pixels[2] = {{1, 2, 3, 4}, {250, 251, 252, 253}};
+  PixelRequest request;
+  request.type = PixelMessageType::kSetPixels;
+  request.first_pixel = 70000;
+  request.pixel_count = 2;
+  request.pixels = &pixels[0].r;
+  std::vector<uint8_t> message(PixelRequestSize(request));
+  EXPECT(message.size() == kPixelRequestHeaderSize + 8);
+  EncodePixelRequest(request, message.data());
+  // Little-endian "BLNK", then version 1 and type 3.
+  EXPECT(message[0] == 'B' && message[3] == 'K' && message[4] == 1 &&
+         message[6] == 3);
+  EXPECT(message[8] == 0x70 && message[9] == 0x11 && message[10] == 0x01);
+  EXPECT(message[kPixelRequestHeaderSize + 7] == 253);
+
+  PixelRequest parsed;
+  EXPECT(ParsePixelRequest(message.data(), message.size(), &parsed));
+  EXPECT(parsed.type == PixelMessageType::kSetPixels);
+  EXPECT(parsed.first_pixel == 70000 && parsed.pixel_count == 2);
+  EXPECT(parsed.pixels == message.data() + kPixelRequestHeaderSize);
+  // A truncated payload, a bad magic and an unknown type are rejected.
+  EXPECT(!ParsePixelRequest(message.data(), message.size() - 1, &parsed));
+  message[6] = 9;
+  EXPECT(!ParsePixelRequest(message.data(), message.size(), &parsed));
+  message[6] = 3;
+  message[0] = 'X';
+  EXPECT(!ParsePixelRequest(message.data(), message.size(), &parsed));
+
+  PixelResponseHeader header;
+  header.status = PixelStatus::kOutOfRange;
+  header.width = 320;
+  header.height = 240;
+  header.frame_index = uint64_t{1} << 40;
+  header.pixel_count = 76800;
+  PipelineStats stats;
+  stats.frames_rendered = 12;
+  stats.frames_dropped = 3;
+  stats.arena_high_water = 4096;
+  std::vector<uint8_t> response(kPixelResponseHeaderSize + kPixelStatsSize);
+  EncodePixelResponseHeader(header, response.data());
+  EncodePixelStats(stats, response.data() + kPixelResponseHeaderSize);
+  PixelResponseHeader parsed_header;
+  PipelineStats parsed_stats;
+  EXPECT(ParsePixelResponseHeader(response.data(), response.size(),
+                                  &parsed_header));
+  EXPECT(parsed_header.status == PixelStatus::kOutOfRange &&
+         parsed_header.width == 320 && parsed_header.height == 240 &&
+         parsed_header.frame_index == header.frame_index &&
+         parsed_header.pixel_count == 76800);
+  EXPECT(ParsePixelStats(response.data() + kPixelResponseHeaderSize,
+                         kPixelStatsSize, &parsed_stats));
+  EXPECT(parsed_stats.frames_rendered == 12 &&
+         parsed_stats.frames_dropped == 3 &&
+         parsed_stats.arena_high_water == 4096 &&
+         parsed_stats.heap_allocations == 0);
+}
+
+// Returns true if the next datagram on |fd| is exactly |packet|'s data.
+bool ReceivedPacket(int fd, const Packet& packet) {
+  uint8_t buffer[RenderPipeline::kPacketBytes + 1];
+  const ssize_t size = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+  return size == packet.size &&
+         std::equal(buffer, buffer + size, packet.data);
+}
+
+void TestOutputTransports() {
+  // Five full universes.
+  RenderPipeline pipeline(Layout{170, 5});
+  LayerConfig config;
+  config.renderer = kSolid;
+  pipeline.AddLayer(config);
+  const Frame* frame = pipeline.RenderFrame(0.0);
+  EXPECT(frame->packet_count == 5);
+
+  for (OutputBackend backend :
+       {OutputBackend::kSyscall, OutputBackend::kIoUring}) {
+    // Universes 0-1 are written to a connected socket, 2 is sent to an
+    // address, 3 goes to a bad descriptor and 4 has no target.
+    int pair[2];
+    EXPECT(socketpair(AF_UNIX, SOCK_DGRAM, 0, pair) == 0);
+    const int receiver = socket(AF_UNIX, SOCK_DGRAM, 0);
+    const int sender = socket(AF_UNIX, SOCK_DGRAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    const std::string name =
+        "blinky-output-test-" + std::to_string(getpid()) + "-" +
+        std::to_string(static_cast<int>(backend));
+    std::copy(name.begin(), name.end(), address.sun_path + 1);
+    const socklen_t address_length =
+        static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 +
+                               name.size());
+    EXPECT(bind(receiver, reinterpret_cast<sockaddr*>(&address),
+                address_length) == 0);
+
+    std::vector<OutputTarget> targets(3);
+    targets[0].fd = pair[0];
+    targets[0].universe_count = 2;
+    targets[1].fd = sender;
+    std::memcpy(&targets[1].address, &address, address_length);
+    targets[1].address_length = address_length;
+    targets[1].first_universe = 2;
+    targets[2].fd = -1;
+    targets[2].first_universe = 3;
+    std::unique_ptr<OutputTransport> transport =
+        CreateOutputTransport(backend, std::move(targets), pipeline);
+
+    EXPECT(!transport->Send(*frame));
+    EXPECT(ReceivedPacket(pair[1], frame->packets[0]));
+    EXPECT(ReceivedPacket(pair[1], frame->packets[1]));
+    EXPECT(ReceivedPacket(receiver, frame->packets[2]));
+    const OutputStats& stats = transport->stats();
+    EXPECT(stats.frames_sent == 1 && stats.packets_sent == 3);
+    EXPECT(stats.send_errors == 1 && stats.last_error == EBADF);
+    EXPECT(stats.packets_unrouted == 1);
+    // Batching is the point of io_uring: one syscall for the whole frame.
+    EXPECT(stats.syscalls ==
+           (transport->backend() == OutputBackend::kIoUring ? 1u : 4u));
+
+#ifdef BLINKY_ENGINE_IO_URING
+    // When the ring fails, the packets it never took are resent with
+    // syscalls, and later frames use syscalls from the start.
+    if (auto* ring = dynamic_cast<IoUringTransport*>(transport.get())) {
+      ring->CloseRingForTesting();
+      for (int i = 0; i < 2; ++i) {
+        EXPECT(!transport->Send(*frame));
+        EXPECT(ReceivedPacket(pair[1], frame->packets[0]));
+        EXPECT(ReceivedPacket(pair[1], frame->packets[1]));
+        EXPECT(ReceivedPacket(receiver, frame->packets[2]));
+      }
+      EXPECT(transport->backend() == OutputBackend::kSyscall);
+      EXPECT(stats.packets_sent == 9 && stats.send_errors == 3);
+      // One failed io_uring_enter(), then four sends per frame.
+      EXPECT(stats.syscalls == 1u + 1u + 4u + 4u);
+    }
+#endif
+
+    for (int fd : {pair[0], pair[1], receiver, sender}) close(fd);
+  }
+  pipeline.ReleaseFrame(frame);
+}
+
+struct TestCase {
+  const char* name;
+  void (*run)();
+};
+
+const TestCase kTests[] = {
+    {"ParseHexColor", TestParseHexColor},
+    {"CompileGradient", TestCompileGradient},
+    {"HardStop", TestHardStop},
+    {"LibrarySharesTables", TestLibrarySharesTables},
+    {"LibraryCopiesStops", TestLibraryCopiesStops},
+    {"Transition", TestTransition},
+    {"SamplePalette", TestSamplePalette},
+    {"FrameArena", TestFrameArena},
+    {"BufferPool", TestBufferPool},
+    {"FixedVector", TestFixedVector},
+    {"AllocationGuard", TestAllocationGuard},
+    {"PipelineComposites", TestPipelineComposites},
+    {"PipelineBackpressure", TestPipelineBackpressure},
+    {"PipelineSteadyStateDoesNotAllocate",
+     TestPipelineSteadyStateDoesNotAllocate},
+    {"PipelineReportsAllocations", TestPipelineReportsAllocations},
+    {"PipelineRendersPaletteTransition",
+     TestPipelineRendersPaletteTransition},
+    {"PipelineOutputFormat", TestPipelineOutputFormat},
+    {"PixelFormats", TestPixelFormats},
+    {"RegistryMatchesApp", TestRegistryMatchesApp},
+    {"EffectsPackInEveryFormat", TestEffectsPackInEveryFormat},
+    {"EffectLayersDoNotAllocate", TestEffectLayersDoNotAllocate},
+    {"EffectLayersMissingInputsAreSkipped",
+     TestEffectLayersMissingInputsAreSkipped},
+    {"WorkerPoolRunsEveryTaskOnce", TestWorkerPoolRunsEveryTaskOnce},
+    {"TiledRenderIsThreadCountInvariant",
+     TestTiledRenderIsThreadCountInvariant},
+    {"PixelProtocol", TestPixelProtocol},
+    {"OutputTransports", TestOutputTransports},
+};
+
+}  // namespace
+}  // namespace blinky
+
+int main() {
+  for (const blinky::TestCase& test : blinky::kTests) {
+    const int failures_before = blinky::g_failures;
+    test.run();
+    std::printf("[%s] %s\n",
+                blinky::g_failures == failures_before ? "  OK  " : " FAIL ",
+                test.name);
+  }
+  return blinky::g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
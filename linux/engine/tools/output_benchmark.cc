@@ -0,0 +1,224 @@
+// Measures the cost of sending frames to many controllers with each output
+// backend: system calls and CPU time (user + system, including io_uring
+// worker threads) per frame.
+//
+// Every controller is a UDP socket on the loopback interface that receives
+// a run of universes. Receivers are never drained; the kernel drops what
+// doesn't fit, which costs the sender nothing extra.
+//
+//   output_benchmark [--controllers=48] [--universes=4] [--frames=2000]
+//                    [--addressed] [--remote=ADDRESS:PORT]
+//
+// --universes is per controller. By default each controller has its own
+// connected socket and packets are written to it; --addressed shares one
+// socket and gives every packet a destination, as sendto() would.
+//
+// On loopback the receive path runs in the sender's context and is charged
+// to it. --remote sends controller i to IPv4 ADDRESS, port PORT + i
+// instead, so receivers can live behind a veth pair in another network
+// namespace or on another host.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/effect_registry.h"
+#include "engine/output_transport.h"
+#include "engine/palette.h"
+#include "engine/render_pipeline.h"
+
+namespace blinky {
+namespace {
+
+struct Options {
+  size_t controllers = 48;
+  size_t universes = 4;
+  size_t frames = 2000;
+  bool addressed = false;
+  // Network order; INADDR_ANY means local loopback receivers.
+  in_addr_t remote_address = INADDR_ANY;
+  uint16_t remote_port = 0;
+};
+
+bool ParseRemote(const char* arg, Options* options) {
+  const char* colon = std::strrchr(arg, ':');
+  if (colon == nullptr) return false;
+  const std::string host(arg, colon);
+  in_addr address;
+  if (inet_pton(AF_INET, host.c_str(), &address) != 1) return false;
+  const unsigned long port = std::strtoul(colon + 1, nullptr, 10);
+  if (port == 0 || port > UINT16_MAX) return false;
+  options->remote_address = address.s_addr;
+  options->remote_port = static_cast<uint16_t>(port);
+  return true;
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (std::strncmp(arg, "--controllers=", 14) == 0) {
+      options->controllers = std::strtoul(arg + 14, nullptr, 10);
+    } else if (std::strncmp(arg, "--universes=", 12) == 0) {
+      options->universes = std::strtoul(arg + 12, nullptr, 10);
+    } else if (std::strncmp(arg, "--frames=", 9) == 0) {
+      options->frames = std::strtoul(arg + 9, nullptr, 10);
+    } else if (std::strcmp(arg, "--addressed") == 0) {
+      options->addressed = true;
+    } else if (std::strncmp(arg, "--remote=", 9) == 0) {
+      if (!ParseRemote(arg + 9, options)) return false;
+    } else {
+      return false;
+    }
+  }
+  return options->controllers > 0 && options->universes > 0 &&
+         options->frames > 0 &&
+         options->controllers * options->universes <= UINT16_MAX &&
+         options->remote_port + options->controllers - 1 <= UINT16_MAX;
+}
+
+double CpuMicros() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+// Owns the sockets on both ends of every controller, or only the sending
+// end with --remote.
+class Controllers {
+ public:
+  explicit Controllers(const Options& options) {
+    const bool remote = options.remote_address != INADDR_ANY;
+    const int shared = options.addressed ? Open() : -1;
+    for (size_t i = 0; i < options.controllers; ++i) {
+      sockaddr_in address = {};
+      address.sin_family = AF_INET;
+      socklen_t length = sizeof(address);
+      sockaddr* generic = reinterpret_cast<sockaddr*>(&address);
+      if (remote) {
+        address.sin_addr.s_addr = options.remote_address;
+        address.sin_port =
+            htons(static_cast<uint16_t>(options.remote_port + i));
+      } else {
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        const int receiver = Open();
+        if (bind(receiver, generic, length) != 0 ||
+            getsockname(receiver, generic, &length) != 0) {
+          std::perror("bind");
+          std::exit(EXIT_FAILURE);
+        }
+      }
+
+      OutputTarget target;
+      target.first_universe = static_cast<uint16_t>(i * options.universes);
+      target.universe_count = static_cast<uint16_t>(options.universes);
+      if (options.addressed) {
+        target.fd = shared;
+        std::memcpy(&target.address, &address, length);
+        target.address_length = length;
+      } else {
+        target.fd = Open();
+        if (connect(target.fd, generic, length) != 0) {
+          std::perror("connect");
+          std::exit(EXIT_FAILURE);
+        }
+      }
+      targets_.push_back(target);
+    }
+  }
+
+  ~Controllers() {
+    for (int fd : fds_) close(fd);
+  }
+
+  const std::vector<OutputTarget>& targets() const { return targets_; }
+
+ private:
+  int Open() {
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+      std::perror("socket");
+      std::exit(EXIT_FAILURE);
+    }
+    fds_.push_back(fd);
+    return fd;
+  }
+
+  std::vector<int> fds_;
+  std::vector<OutputTarget> targets_;
+};
+
+void Run(OutputBackend backend, const Options& options,
+         const RenderPipeline& pipeline, const Frame& frame) {
+  Controllers controllers(options);
+  std::unique_ptr<OutputTransport> transport =
+      CreateOutputTransport(backend, controllers.targets(), pipeline);
+  const bool io_uring = transport->backend() == OutputBackend::kIoUring;
+  if (backend == OutputBackend::kIoUring && !io_uring) {
+    std::printf("io_uring    unavailable, skipped\n");
+    return;
+  }
+
+  transport->Send(frame);  // Warm up.
+  const OutputStats before = transport->stats();
+  const double cpu_start = CpuMicros();
+  const auto wall_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < options.frames; ++i) transport->Send(frame);
+  const std::chrono::duration<double, std::micro> wall =
+      std::chrono::steady_clock::now() - wall_start;
+  const double cpu = CpuMicros() - cpu_start;
+  const OutputStats& after = transport->stats();
+
+  const double frames = static_cast<double>(options.frames);
+  std::printf("%-10s %9.1f %11.1f %12.1f %8llu\n",
+              io_uring ? "io_uring" : "syscall",
+              (after.syscalls - before.syscalls) / frames, cpu / frames,
+              wall.count() / frames,
+              static_cast<unsigned long long>(after.send_errors -
+                                              before.send_errors));
+}
+
+}  // namespace
+}  // namespace blinky
+
+int main(int argc, char** argv) {
+  using namespace blinky;
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    std::fprintf(stderr,
+                 "usage: %s [--controllers=N] [--universes=N] [--frames=N] "
+                 "[--addressed] [--remote=ADDRESS:PORT]\n",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // One row of 170 RGB pixels fills a universe.
+  PaletteLibrary palettes;
+  RenderPipeline pipeline(
+      Layout{170, static_cast<uint32_t>(options.controllers *
+                                        options.universes)});
+  pipeline.AddLayer(MakeEffectLayer(EffectId::kRainbowSwirl, &palettes));
+  const Frame* frame = pipeline.RenderFrame(0.0);
+
+  std::printf("%zu controllers x %zu universes, %zu packets/frame, %s, "
+              "%s\n\n",
+              options.controllers, options.universes, frame->packet_count,
+              options.addressed ? "sendto" : "connected write",
+              options.remote_address != INADDR_ANY ? "remote" : "loopback");
+  std::printf("%-10s %9s %11s %12s %8s\n", "backend", "syscalls",
+              "cpu us", "wall us", "errors");
+  Run(OutputBackend::kSyscall, options, pipeline, *frame);
+  Run(OutputBackend::kIoUring, options, pipeline, *frame);
+  pipeline.ReleaseFrame(frame);
+  return EXIT_SUCCESS;
+}
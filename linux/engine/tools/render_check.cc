@@ -0,0 +1,377 @@
+// Renders registry effects offline and checks their output against golden
+// hashes.
+//
+// Each effect gets its own pipeline and runs for a fixed number of frames
+// on a simulated clock (frame / fps seconds), as fast as the CPU allows.
+// Effects are independent, so they render in parallel, one per core.
+// Every frame's pixels are hashed; an effect's digest is the hash of its
+// frame hashes, and that is what goldens record.
+//
+//   blinky_render_check [--layout=WxH] [--frames=N] [--fps=F]
+//                       [--effects=Name,Name|ID,...] [--threads=N]
+//                       [--report=FILE] [--golden=FILE]
+//                       [--update-golden=FILE]
+//
+// The report is tab-separated: a line per frame with its hash and render
+// time, then a summary line per effect. Exits with 1 if any digest differs
+// from the golden file and 2 on usage or I/O errors.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "engine/effect_registry.h"
+#include "engine/palette.h"
+#include "engine/render_pipeline.h"
+#include "engine/worker_pool.h"
+
+namespace blinky {
+namespace {
+
+constexpr int kMismatch = 1;
+constexpr int kUsageError = 2;
+
+// Defaults match test/render_goldens.txt.
+struct Settings {
+  Layout layout{96, 64};
+  size_t frames = 240;
+  double fps = 60.0;
+
+  bool operator==(const Settings& other) const {
+    return layout.width == other.layout.width &&
+           layout.height == other.layout.height && frames == other.frames &&
+           fps == other.fps;
+  }
+};
+
+struct Options {
+  Settings settings;
+  std::vector<EffectId> effects;
+  size_t threads = 0;
+  std::string report_path;
+  std::string golden_path;
+  std::string update_golden_path;
+};
+
+struct EffectRun {
+  EffectId id;
+  std::vector<uint64_t> frame_hashes;
+  std::vector<double> frame_micros;
+  uint64_t digest = 0;
+  bool rendered = true;
+};
+
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325;
+constexpr uint64_t kFnvPrime = 0x100000001b3;
+
+uint64_t Fnv1a(const uint8_t* data, size_t size, uint64_t hash = kFnvOffset) {
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ data[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+uint64_t Digest(const std::vector<uint64_t>& frame_hashes) {
+  uint64_t hash = kFnvOffset;
+  for (uint64_t frame_hash : frame_hashes) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; ++i) {
+      bytes[i] = static_cast<uint8_t>(frame_hash >> (8 * i));
+    }
+    hash = Fnv1a(bytes, sizeof(bytes), hash);
+  }
+  return hash;
+}
+
+// fps is written with enough digits to read back exactly, so any rate
+// given on the command line matches its own golden file.
+std::string FormatSettings(const Settings& settings) {
+  char line[96];
+  std::snprintf(line, sizeof(line), "layout %ux%u frames %zu fps %.17g",
+                settings.layout.width, settings.layout.height,
+                settings.frames, settings.fps);
+  return line;
+}
+
+bool ParseSettingsLine(const std::string& line, Settings* settings) {
+  return std::sscanf(line.c_str(), "layout %ux%u frames %zu fps %lf",
+                     &settings->layout.width, &settings->layout.height,
+                     &settings->frames, &settings->fps) == 4;
+}
+
+bool ParseEffects(const std::string& list, std::vector<EffectId>* effects) {
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (const EffectInfo* info = FindEffect(item)) {
+      effects->push_back(info->id);
+      continue;
+    }
+    char* end = nullptr;
+    const unsigned long id = std::strtoul(item.c_str(), &end, 10);
+    if (item.empty() || *end != '\0' || id >= kEffectCount) return false;
+    effects->push_back(static_cast<EffectId>(id));
+  }
+  return !effects->empty();
+}
+
+// Returns the value of "--|name|=value" in |arg|, or null.
+const char* FlagValue(const char* arg, const char* name) {
+  const size_t length = std::strlen(name);
+  if (std::strncmp(arg, "--", 2) != 0 ||
+      std::strncmp(arg + 2, name, length) != 0 || arg[2 + length] != '=') {
+    return nullptr;
+  }
+  return arg + 3 + length;
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  Settings& settings = options->settings;
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    const char* value = nullptr;
+    if ((value = FlagValue(arg, "layout"))) {
+      if (std::sscanf(value, "%ux%u", &settings.layout.width,
+                      &settings.layout.height) != 2) {
+        return false;
+      }
+    } else if ((value = FlagValue(arg, "frames"))) {
+      settings.frames = std::strtoul(value, nullptr, 10);
+    } else if ((value = FlagValue(arg, "fps"))) {
+      settings.fps = std::strtod(value, nullptr);
+    } else if ((value = FlagValue(arg, "effects"))) {
+      if (!ParseEffects(value, &options->effects)) return false;
+    } else if ((value = FlagValue(arg, "threads"))) {
+      options->threads = std::strtoul(value, nullptr, 10);
+    } else if ((value = FlagValue(arg, "report"))) {
+      options->report_path = value;
+    } else if ((value = FlagValue(arg, "golden"))) {
+      options->golden_path = value;
+    } else if ((value = FlagValue(arg, "update-golden"))) {
+      options->update_golden_path = value;
+    } else {
+      return false;
+    }
+  }
+  if (options->effects.empty()) {
+    for (const EffectInfo& info : kEffects) {
+      options->effects.push_back(info.id);
+    }
+  }
+  return settings.layout.pixel_count() > 0 && settings.frames > 0 &&
+         settings.fps > 0.0;
+}
+
+// Renders one effect on its own pipeline, on the calling thread.
+void RenderEffect(const Settings& settings, PaletteLibrary* palettes,
+                  EffectRun* run) {
+  RenderPipeline pipeline(settings.layout);
+  pipeline.AddLayer(MakeEffectLayer(run->id, palettes));
+  const size_t pixel_bytes = settings.layout.pixel_count() * sizeof(Rgba8);
+  for (size_t i = 0; i < settings.frames; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    const Frame* frame = pipeline.RenderFrame(i / settings.fps);
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (frame == nullptr) {
+      run->rendered = false;
+      return;
+    }
+    run->frame_hashes[i] = Fnv1a(
+        reinterpret_cast<const uint8_t*>(frame->pixels), pixel_bytes);
+    run->frame_micros[i] = elapsed.count();
+    pipeline.ReleaseFrame(frame);
+  }
+  run->digest = Digest(run->frame_hashes);
+}
+
+// Reads "name<TAB>digest" lines. Returns false if the file can't be read
+// or was recorded with different settings.
+bool ReadGolden(const std::string& path, const Settings& settings,
+                std::vector<std::pair<std::string, uint64_t>>* digests) {
+  std::ifstream file(path);
+  if (!file) {
+    std::fprintf(stderr, "cannot read %s\n", path.c_str());
+    return false;
+  }
+  std::string line;
+  bool have_settings = false;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    if (!have_settings) {
+      Settings golden;
+      if (!ParseSettingsLine(line, &golden)) {
+        std::fprintf(stderr, "%s: bad settings line \"%s\"\n", path.c_str(),
+                     line.c_str());
+        return false;
+      }
+      if (!(golden == settings)) {
+        std::fprintf(stderr, "%s was recorded with \"%s\", not \"%s\"\n",
+                     path.c_str(), FormatSettings(golden).c_str(),
+                     FormatSettings(settings).c_str());
+        return false;
+      }
+      have_settings = true;
+      continue;
+    }
+    const size_t tab = line.find('\t');
+    if (tab == std::string::npos) continue;
+    digests->emplace_back(
+        line.substr(0, tab),
+        std::strtoull(line.c_str() + tab + 1, nullptr, 16));
+  }
+  return have_settings;
+}
+
+bool WriteGolden(const std::string& path, const Settings& settings,
+                 const std::vector<EffectRun>& runs) {
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    std::fprintf(stderr, "cannot write %s\n", path.c_str());
+    return false;
+  }
+  std::fprintf(file,
+               "# Golden effect digests for blinky_render_check.\n"
+               "# Regenerate with blinky_render_check --update-golden=FILE "
+               "after an intended\n# visual change.\n");
+  std::fprintf(file, "%s\n", FormatSettings(settings).c_str());
+  for (const EffectRun& run : runs) {
+    std::fprintf(file, "%s\t%016" PRIx64 "\n", GetEffectInfo(run.id).name,
+                 run.digest);
+  }
+  return std::fclose(file) == 0;
+}
+
+double Percentile(std::vector<double> values, double fraction) {
+  std::sort(values.begin(), values.end());
+  return values[static_cast<size_t>(fraction * (values.size() - 1))];
+}
+
+bool WriteReport(const std::string& path, const Settings& settings,
+                 const std::vector<EffectRun>& runs,
+                 const std::vector<const char*>& statuses) {
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    std::fprintf(stderr, "cannot write %s\n", path.c_str());
+    return false;
+  }
+  std::fprintf(file, "# %s\n", FormatSettings(settings).c_str());
+  std::fprintf(file, "# effect\tframe\ttime\thash\trender_us\n");
+  for (const EffectRun& run : runs) {
+    for (size_t i = 0; i < run.frame_hashes.size(); ++i) {
+      std::fprintf(file, "%s\t%zu\t%.6f\t%016" PRIx64 "\t%.1f\n",
+                   GetEffectInfo(run.id).name, i, i / settings.fps,
+                   run.frame_hashes[i], run.frame_micros[i]);
+    }
+  }
+  std::fprintf(file,
+               "# effect\tdigest\tmean_us\tp50_us\tp99_us\tmax_us\tstatus\n");
+  for (size_t r = 0; r < runs.size(); ++r) {
+    const EffectRun& run = runs[r];
+    double total = 0.0;
+    for (double micros : run.frame_micros) total += micros;
+    std::fprintf(file, "%s\t%016" PRIx64 "\t%.1f\t%.1f\t%.1f\t%.1f\t%s\n",
+                 GetEffectInfo(run.id).name, run.digest,
+                 total / run.frame_micros.size(),
+                 Percentile(run.frame_micros, 0.5),
+                 Percentile(run.frame_micros, 0.99),
+                 Percentile(run.frame_micros, 1.0), statuses[r]);
+  }
+  return std::fclose(file) == 0;
+}
+
+int Main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    std::fprintf(stderr,
+                 "usage: %s [--layout=WxH] [--frames=N] [--fps=F] "
+                 "[--effects=Name,ID,...]\n"
+                 "          [--threads=N] [--report=FILE] [--golden=FILE] "
+                 "[--update-golden=FILE]\n",
+                 argv[0]);
+    return kUsageError;
+  }
+  const Settings& settings = options.settings;
+
+  std::vector<std::pair<std::string, uint64_t>> golden;
+  if (!options.golden_path.empty() &&
+      !ReadGolden(options.golden_path, settings, &golden)) {
+    return kUsageError;
+  }
+
+  // Everything the workers write is sized up front.
+  std::vector<EffectRun> runs;
+  for (EffectId id : options.effects) {
+    EffectRun run;
+    run.id = id;
+    run.frame_hashes.resize(settings.frames);
+    run.frame_micros.resize(settings.frames);
+    runs.push_back(std::move(run));
+  }
+
+  PaletteLibrary palettes;
+  WorkerPool pool(options.threads);
+  const auto start = std::chrono::steady_clock::now();
+  pool.Run(runs.size(), [&](size_t task, size_t) {
+    RenderEffect(settings, &palettes, &runs[task]);
+  });
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  int result = EXIT_SUCCESS;
+  std::vector<const char*> statuses;
+  for (const EffectRun& run : runs) {
+    const char* name = GetEffectInfo(run.id).name;
+    const char* status = "ok";
+    if (!run.rendered) {
+      status = "failed";
+    } else if (!options.golden_path.empty()) {
+      const auto entry = std::find_if(
+          golden.begin(), golden.end(),
+          [name](const std::pair<std::string, uint64_t>& digest) {
+            return digest.first == name;
+          });
+      if (entry == golden.end()) {
+        status = "no-golden";
+      } else if (entry->second != run.digest) {
+        status = "mismatch";
+      }
+    }
+    if (std::strcmp(status, "ok") != 0) result = kMismatch;
+    statuses.push_back(status);
+    std::printf("%-18s %016" PRIx64 "  %s\n", name, run.digest, status);
+  }
+
+  const double simulated = settings.frames / settings.fps * runs.size();
+  std::printf("%zu effects x %zu frames on %zu threads in %.2f s "
+              "(%.0fx real time)\n",
+              runs.size(), settings.frames, pool.thread_count(),
+              elapsed.count(), simulated / elapsed.count());
+
+  if (!options.report_path.empty() &&
+      !WriteReport(options.report_path, settings, runs, statuses)) {
+    return kUsageError;
+  }
+  if (!options.update_golden_path.empty()) {
+    if (!WriteGolden(options.update_golden_path, settings, runs)) {
+      return kUsageError;
+    }
+    // Recording goldens is not a check.
+    return EXIT_SUCCESS;
+  }
+  return result;
+}
+
+}  // namespace
+}  // namespace blinky
+
+int main(int argc, char** argv) {
+  return blinky::Main(argc, argv);
+}
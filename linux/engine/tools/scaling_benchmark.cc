@@ -0,0 +1,130 @@
+// Measures how frame rendering scales with threads: renders one large
+// layout through RenderPipeline with a WorkerPool of each size from 1 to
+// --threads and reports wall time per frame.
+//
+//   scaling_benchmark [--width=500] [--height=500] [--frames=200]
+//                     [--threads=N] [--effect=NAME]...
+//
+// --threads defaults to one per hardware thread. Each --effect adds a
+// layer at half opacity; without any, Rainbow Swirl, Fire and Twinkle are
+// stacked so both stateless and stateful kernels are covered.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "engine/effect_registry.h"
+#include "engine/palette.h"
+#include "engine/render_pipeline.h"
+#include "engine/worker_pool.h"
+
+namespace blinky {
+namespace {
+
+// Frames rendered before timing starts, so state buffers and caches are
+// warm.
+constexpr size_t kWarmupFrames = 10;
+
+struct Options {
+  uint32_t width = 500;
+  uint32_t height = 500;
+  size_t frames = 200;
+  size_t threads = 0;
+  std::vector<EffectId> effects;
+};
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (std::strncmp(arg, "--width=", 8) == 0) {
+      options->width =
+          static_cast<uint32_t>(std::strtoul(arg + 8, nullptr, 10));
+    } else if (std::strncmp(arg, "--height=", 9) == 0) {
+      options->height =
+          static_cast<uint32_t>(std::strtoul(arg + 9, nullptr, 10));
+    } else if (std::strncmp(arg, "--frames=", 9) == 0) {
+      options->frames = std::strtoul(arg + 9, nullptr, 10);
+    } else if (std::strncmp(arg, "--threads=", 10) == 0) {
+      options->threads = std::strtoul(arg + 10, nullptr, 10);
+    } else if (std::strncmp(arg, "--effect=", 9) == 0) {
+      const EffectInfo* info = FindEffect(arg + 9);
+      if (info == nullptr) {
+        std::fprintf(stderr, "unknown effect: %s\n", arg + 9);
+        return false;
+      }
+      options->effects.push_back(info->id);
+    } else {
+      return false;
+    }
+  }
+  if (options->threads == 0) {
+    options->threads = std::thread::hardware_concurrency();
+    if (options->threads == 0) options->threads = 1;
+  }
+  if (options->effects.empty()) {
+    options->effects = {EffectId::kRainbowSwirl, EffectId::kFire,
+                        EffectId::kTwinkle};
+  }
+  return options->width > 0 && options->height > 0 && options->frames > 0;
+}
+
+// Returns the mean wall time per frame, in milliseconds, with a pool of
+// |threads|.
+double MeasureFrameMs(const Options& options, PaletteLibrary* palettes,
+                      size_t threads) {
+  WorkerPool pool(threads);
+  RenderPipeline pipeline(Layout{options.width, options.height},
+                          PixelFormat::kRgb, &pool);
+  for (EffectId id : options.effects) {
+    LayerConfig config = MakeEffectLayer(id, palettes);
+    config.opacity = 128;
+    pipeline.AddLayer(std::move(config));
+  }
+
+  size_t frame_index = 0;
+  const auto render = [&pipeline, &frame_index] {
+    pipeline.ReleaseFrame(pipeline.RenderFrame(frame_index++ / 60.0));
+  };
+  for (size_t i = 0; i < kWarmupFrames; ++i) render();
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < options.frames; ++i) render();
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / static_cast<double>(options.frames);
+}
+
+}  // namespace
+}  // namespace blinky
+
+int main(int argc, char** argv) {
+  using namespace blinky;
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    std::fprintf(stderr,
+                 "usage: %s [--width=N] [--height=N] [--frames=N] "
+                 "[--threads=N] [--effect=NAME]...\n",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const Layout layout{options.width, options.height};
+  std::printf("%ux%u (%zu pixels, %zu tiles), %zu layers, %zu frames\n\n",
+              layout.width, layout.height, layout.pixel_count(),
+              TileCount(layout), options.effects.size(), options.frames);
+  std::printf("%-8s %10s %8s %11s\n", "threads", "ms/frame", "speedup",
+              "efficiency");
+  PaletteLibrary palettes;
+  double single_thread_ms = 0.0;
+  for (size_t threads = 1; threads <= options.threads; ++threads) {
+    const double ms = MeasureFrameMs(options, &palettes, threads);
+    if (threads == 1) single_thread_ms = ms;
+    const double speedup = single_thread_ms / ms;
+    std::printf("%-8zu %10.3f %7.2fx %10.0f%%\n", threads, ms, speedup,
+                100.0 * speedup / static_cast<double>(threads));
+  }
+  return EXIT_SUCCESS;
+}
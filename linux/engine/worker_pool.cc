@@ -0,0 +1,132 @@
+#include "engine/worker_pool.h"
+
+namespace blinky {
+
+namespace {
+
+uint64_t PackRange(uint32_t begin, uint32_t end) {
+  return (uint64_t{begin} << 32) | end;
+}
+
+uint32_t RangeBegin(uint64_t range) {
+  return static_cast<uint32_t>(range >> 32);
+}
+
+uint32_t RangeEnd(uint64_t range) {
+  return static_cast<uint32_t>(range);
+}
+
+}  // namespace
+
+WorkerPool::WorkerPool(size_t thread_count)
+    : thread_count_(thread_count > 0 ? thread_count
+                                     : std::thread::hardware_concurrency()) {
+  if (thread_count_ == 0) thread_count_ = 1;
+  queues_.reset(new Queue[thread_count_]);
+  threads_.reserve(thread_count_ - 1);
+  for (size_t worker = 1; worker < thread_count_; ++worker) {
+    threads_.emplace_back(&WorkerPool::ThreadMain, this, worker);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  start_.notify_all();
+  for (std::thread& thread : threads_) thread.join();
+}
+
+void WorkerPool::Run(size_t task_count, TaskFn fn, void* context) {
+  if (task_count == 0) return;
+  const uint32_t count = static_cast<uint32_t>(task_count);
+  for (size_t worker = 0; worker < thread_count_; ++worker) {
+    queues_[worker].range.store(
+        PackRange(static_cast<uint32_t>(count * worker / thread_count_),
+                  static_cast<uint32_t>(count * (worker + 1) / thread_count_)),
+        std::memory_order_relaxed);
+  }
+  fn_ = fn;
+  context_ = context;
+
+  if (!threads_.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_workers_ = threads_.size();
+      ++generation_;
+    }
+    start_.notify_all();
+  }
+
+  Work(0);
+
+  if (!threads_.empty()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_workers_ == 0; });
+  }
+}
+
+void WorkerPool::ThreadMain(size_t worker) {
+  uint64_t seen_generation = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [&] {
+        return stopping_ || generation_ != seen_generation;
+      });
+      if (stopping_) return;
+      seen_generation = generation_;
+    }
+
+    Work(worker);
+
+    bool last;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last = --busy_workers_ == 0;
+    }
+    if (last) done_.notify_one();
+  }
+}
+
+void WorkerPool::Work(size_t worker) {
+  size_t task;
+  while (TakeFront(worker, &task)) fn_(context_, task, worker);
+  for (size_t offset = 1; offset < thread_count_; ++offset) {
+    const size_t victim = (worker + offset) % thread_count_;
+    while (TakeBack(victim, &task)) fn_(context_, task, worker);
+  }
+}
+
+bool WorkerPool::TakeFront(size_t queue, size_t* task) {
+  std::atomic<uint64_t>& range = queues_[queue].range;
+  uint64_t current = range.load(std::memory_order_acquire);
+  for (;;) {
+    const uint32_t begin = RangeBegin(current);
+    const uint32_t end = RangeEnd(current);
+    if (begin >= end) return false;
+    if (range.compare_exchange_weak(current, PackRange(begin + 1, end),
+                                    std::memory_order_acq_rel)) {
+      *task = begin;
+      return true;
+    }
+  }
+}
+
+bool WorkerPool::TakeBack(size_t queue, size_t* task) {
+  std::atomic<uint64_t>& range = queues_[queue].range;
+  uint64_t current = range.load(std::memory_order_acquire);
+  for (;;) {
+    const uint32_t begin = RangeBegin(current);
+    const uint32_t end = RangeEnd(current);
+    if (begin >= end) return false;
+    if (range.compare_exchange_weak(current, PackRange(begin, end - 1),
+                                    std::memory_order_acq_rel)) {
+      *task = end - 1;
+      return true;
+    }
+  }
+}
+
+}  // namespace blinky
@@ -0,0 +1,82 @@
+#ifndef BLINKY_ENGINE_WORKER_POOL_H_
+#define BLINKY_ENGINE_WORKER_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace blinky {
+
+// A persistent set of threads that runs batches of independent tasks.
+//
+// Run() splits a batch evenly across per-worker queues; a worker that
+// drains its own queue steals from the back of the others'. Run() returns
+// only when every task has finished, which makes it the frame barrier.
+// Dispatching a batch does not allocate, so it is safe in the frame loop.
+class WorkerPool {
+ public:
+  using TaskFn = void (*)(void* context, size_t task, size_t worker);
+
+  // |thread_count| includes the thread calling Run(); 0 means one per
+  // hardware thread.
+  explicit WorkerPool(size_t thread_count = 0);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  size_t thread_count() const { return thread_count_; }
+
+  // Calls |fn|(|context|, task, worker) for every task in [0, task_count)
+  // and waits for all of them. |worker| is in [0, thread_count()) and is
+  // unique among concurrently running tasks, so it can index per-worker
+  // scratch memory. Not reentrant: tasks must not call Run().
+  void Run(size_t task_count, TaskFn fn, void* context);
+
+  // Runs |task|(task_index, worker) for every task.
+  template <typename Task>
+  void Run(size_t task_count, const Task& task) {
+    Run(task_count, &InvokeTask<Task>,
+        const_cast<void*>(static_cast<const void*>(&task)));
+  }
+
+ private:
+  // Remaining tasks of one worker as [begin, end), packed into one word so
+  // the owner (taking from the front) and thieves (taking from the back)
+  // agree with a single compare-and-swap.
+  struct alignas(64) Queue {
+    std::atomic<uint64_t> range{0};
+  };
+
+  template <typename Task>
+  static void InvokeTask(void* context, size_t task, size_t worker) {
+    (*static_cast<const Task*>(context))(task, worker);
+  }
+
+  void ThreadMain(size_t worker);
+  void Work(size_t worker);
+  bool TakeFront(size_t queue, size_t* task);
+  bool TakeBack(size_t queue, size_t* task);
+
+  size_t thread_count_;
+  std::unique_ptr<Queue[]> queues_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  uint64_t generation_ = 0;
+  size_t busy_workers_ = 0;
+  bool stopping_ = false;
+  TaskFn fn_ = nullptr;
+  void* context_ = nullptr;
+};
+
+}  // namespace blinky
+
+#endif  // BLINKY_ENGINE_WORKER_POOL_H_
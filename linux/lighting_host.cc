@@ -0,0 +1,66 @@
+#include "lighting_host.h"
+
+#include <cstring>
+
+#include "engine/effect_registry.h"
+
+namespace {
+
+// Copies the uploaded zone colors, passed as LayerConfig::user_data.
+const void* PrepareZonePixels(const blinky::EffectContext& context) {
+  return context.user_data;
+}
+
+void RenderZonePixels(const void* prepared,
+                      const blinky::EffectContext& context,
+                      const blinky::Tile& tile, uint8_t* out) {
+  const blinky::Rgba8* zone_pixels =
+      static_cast<const blinky::Rgba8*>(prepared);
+  std::memcpy(out, zone_pixels + tile.begin,
+              tile.size() * sizeof(blinky::Rgba8));
+}
+
+constexpr blinky::EffectRenderer kZoneRenderer = {PrepareZonePixels,
+                                                  RenderZonePixels};
+
+}  // namespace
+
+LightingHost::LightingHost(const blinky::Layout& layout)
+    : pipeline_(layout, blinky::PixelFormat::kRgb),
+      zone_pixels_(new blinky::Rgba8[layout.pixel_count()]()),
+      start_time_us_(g_get_monotonic_time()) {
+  pipeline_.AddLayer(blinky::MakeEffectLayer(blinky::EffectId::kRainbowSwirl,
+                                             &palettes_));
+  blinky::LayerConfig zones;
+  zones.renderer = kZoneRenderer;
+  zones.user_data = zone_pixels_.get();
+  pipeline_.AddLayer(zones);
+}
+
+LightingHost::~LightingHost() {
+  if (latest_frame_ != nullptr) pipeline_.ReleaseFrame(latest_frame_);
+}
+
+void LightingHost::Tick() {
+  latest_frame_time_us_ = g_get_monotonic_time();
+  const double time = (latest_frame_time_us_ - start_time_us_) / 1e6;
+  // Nothing else holds frames, so releasing first always leaves a buffer.
+  if (latest_frame_ != nullptr) pipeline_.ReleaseFrame(latest_frame_);
+  latest_frame_ = pipeline_.RenderFrame(time);
+}
+
+void LightingHost::Refresh(gint64 max_age_us) {
+  if (latest_frame_ != nullptr &&
+      g_get_monotonic_time() - latest_frame_time_us_ < max_age_us) {
+    return;
+  }
+  Tick();
+}
+
+bool LightingHost::SetZonePixels(size_t first, size_t count,
+                                 const uint8_t* rgba) {
+  const size_t pixel_count = layout().pixel_count();
+  if (first > pixel_count || count > pixel_count - first) return false;
+  std::memcpy(zone_pixels_.get() + first, rgba, count * sizeof(blinky::Rgba8));
+  return true;
+}
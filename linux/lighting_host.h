@@ -0,0 +1,61 @@
+#ifndef RUNNER_LIGHTING_HOST_H_
+#define RUNNER_LIGHTING_HOST_H_
+
+#include <glib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "engine/color.h"
+#include "engine/effect.h"
+#include "engine/palette.h"
+#include "engine/render_pipeline.h"
+
+// Runs the native render pipeline inside the desktop app.
+//
+// The pipeline renders an effect layer with the zone colors uploaded by the
+// app composited on top. Frames are rendered only when asked for, by Tick()
+// or Refresh(), so an idle preview costs nothing, and the latest frame stays
+// readable until the next one replaces it. All methods must be called on
+// the thread that renders.
+//
+// Preview layouts are a few tiles, so the pipeline renders them on that
+// thread without a worker pool.
+class LightingHost {
+ public:
+  explicit LightingHost(const blinky::Layout& layout);
+  ~LightingHost();
+
+  LightingHost(const LightingHost&) = delete;
+  LightingHost& operator=(const LightingHost&) = delete;
+
+  // Renders the next frame, replacing latest_frame().
+  void Tick();
+
+  // Calls Tick() unless latest_frame() was rendered less than |max_age_us|
+  // ago.
+  void Refresh(gint64 max_age_us);
+
+  const blinky::Layout& layout() const { return pipeline_.layout(); }
+  const blinky::PipelineStats& stats() const { return pipeline_.stats(); }
+
+  // The most recent frame, or null before the first Tick().
+  const blinky::Frame* latest_frame() const { return latest_frame_; }
+
+  // Replaces zone colors [first, first + count) with premultiplied RGBA
+  // bytes. Returns false, changing nothing, if the range is outside the
+  // layout. Takes effect from the next frame.
+  bool SetZonePixels(size_t first, size_t count, const uint8_t* rgba);
+
+ private:
+  blinky::PaletteLibrary palettes_;
+  blinky::RenderPipeline pipeline_;
+  // Transparent until the app uploads colors.
+  std::unique_ptr<blinky::Rgba8[]> zone_pixels_;
+  const blinky::Frame* latest_frame_ = nullptr;
+  gint64 start_time_us_;
+  gint64 latest_frame_time_us_ = 0;
+};
+
+#endif  // RUNNER_LIGHTING_HOST_H_
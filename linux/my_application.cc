@@ -6,10 +6,19 @@
 #endif
 
 #include "flutter/generated_plugin_registrant.h"
+#include "lighting_host.h"
+#include "pixel_channel.h"
+
+// Pixels rendered by the desktop preview, and the most often a frame is
+// rendered while the app reads them.
+constexpr blinky::Layout kPreviewLayout{128, 80};
+constexpr guint kFrameIntervalMs = 16;
 
 struct _MyApplication {
   GtkApplication parent_instance;
   char** dart_entrypoint_arguments;
+  LightingHost* lighting_host;
+  PixelChannel* pixel_channel;
 };
 
 G_DEFINE_TYPE(MyApplication, my_application, GTK_TYPE_APPLICATION)
@@ -59,6 +68,15 @@ static void my_application_activate(GApplication* application) {
 
   fl_register_plugins(FL_PLUGIN_REGISTRY(view));
 
+  // The host renders only when the channel asks it for a frame.
+  g_autoptr(FlPluginRegistrar) registrar =
+      fl_plugin_registry_get_registrar_for_plugin(FL_PLUGIN_REGISTRY(view),
+                                                  "PixelChannel");
+  self->lighting_host = new LightingHost(kPreviewLayout);
+  self->pixel_channel =
+      new PixelChannel(fl_plugin_registrar_get_messenger(registrar),
+                       self->lighting_host, kFrameIntervalMs);
+
   gtk_widget_grab_focus(GTK_WIDGET(view));
 }
 
@@ -85,6 +103,11 @@ static gboolean my_application_local_command_line(GApplication* application, gch
 static void my_application_dispose(GObject* object) {
   MyApplication* self = MY_APPLICATION(object);
   g_clear_pointer(&self->dart_entrypoint_arguments, g_strfreev);
+  // The channel reads from the host, so it goes first.
+  delete self->pixel_channel;
+  self->pixel_channel = nullptr;
+  delete self->lighting_host;
+  self->lighting_host = nullptr;
   G_OBJECT_CLASS(my_application_parent_class)->dispose(object);
 }
 
@@ -0,0 +1,179 @@
+#include "pixel_channel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// Free buffers kept for reuse. Flutter holds at most a response or two at
+// a time, so anything beyond this is released.
+constexpr size_t kMaxFreeBuffers = 4;
+
+// Buffers grow in whole 64KB steps so a frame of slightly different size
+// still fits a recycled buffer.
+constexpr size_t kBufferGranularity = 64 * 1024;
+
+}  // namespace
+
+struct GBytesPool::Buffer {
+  std::unique_ptr<uint8_t[]> data;
+  size_t capacity = 0;
+  // Set only while leased, so a free buffer doesn't keep the pool alive.
+  std::shared_ptr<State> state;
+};
+
+struct GBytesPool::State {
+  ~State() {
+    for (Buffer* buffer : free) delete buffer;
+  }
+
+  std::mutex mutex;
+  std::vector<Buffer*> free;
+};
+
+GBytesPool::GBytesPool() : state_(std::make_shared<State>()) {
+  state_->free.reserve(kMaxFreeBuffers);
+}
+
+GBytes* GBytesPool::Acquire(size_t size, uint8_t** data) {
+  Buffer* buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    // Prefer the smallest free buffer that fits.
+    std::vector<Buffer*>& free = state_->free;
+    auto best = free.end();
+    for (auto it = free.begin(); it != free.end(); ++it) {
+      if ((*it)->capacity >= size &&
+          (best == free.end() || (*it)->capacity < (*best)->capacity)) {
+        best = it;
+      }
+    }
+    if (best != free.end()) {
+      buffer = *best;
+      free.erase(best);
+    }
+  }
+  if (buffer == nullptr) {
+    buffer = new Buffer();
+    buffer->capacity = std::max<size_t>(
+        (size + kBufferGranularity - 1) / kBufferGranularity *
+            kBufferGranularity,
+        kBufferGranularity);
+    buffer->data.reset(new uint8_t[buffer->capacity]);
+  }
+  buffer->state = state_;
+  *data = buffer->data.get();
+  return g_bytes_new_with_free_func(buffer->data.get(), size, Return, buffer);
+}
+
+// static
+void GBytesPool::Return(gpointer user_data) {
+  Buffer* buffer = static_cast<Buffer*>(user_data);
+  // Keeps the state alive until the lock below is released, even if this
+  // was the last reference.
+  std::shared_ptr<State> state = std::move(buffer->state);
+  std::lock_guard<std::mutex> lock(state->mutex);
+  if (state->free.size() < kMaxFreeBuffers) {
+    state->free.push_back(buffer);
+  } else {
+    delete buffer;
+  }
+}
+
+PixelChannel::PixelChannel(FlBinaryMessenger* messenger, LightingHost* host,
+                           guint frame_interval_ms)
+    : messenger_(messenger),
+      host_(host),
+      frame_interval_ms_(frame_interval_ms) {
+  if (messenger_ == nullptr) return;
+  g_object_ref(messenger_);
+  fl_binary_messenger_set_message_handler_on_channel(
+      messenger_, kChannelName, OnMessage, this, nullptr);
+}
+
+PixelChannel::~PixelChannel() {
+  if (messenger_ == nullptr) return;
+  fl_binary_messenger_set_message_handler_on_channel(
+      messenger_, kChannelName, nullptr, nullptr, nullptr);
+  g_object_unref(messenger_);
+}
+
+GBytes* PixelChannel::HandleMessage(GBytes* message) {
+  gsize size = 0;
+  const uint8_t* data = static_cast<const uint8_t*>(
+      message != nullptr ? g_bytes_get_data(message, &size) : nullptr);
+  blinky::PixelRequest request;
+  if (!blinky::ParsePixelRequest(data, size, &request)) {
+    return Respond(blinky::PixelStatus::kBadRequest);
+  }
+
+  uint8_t* payload = nullptr;
+  switch (request.type) {
+    case blinky::PixelMessageType::kGetFrame: {
+      if (frame_interval_ms_ != 0) {
+        host_->Refresh(gint64{frame_interval_ms_} * G_TIME_SPAN_MILLISECOND);
+      }
+      const blinky::Frame* frame = host_->latest_frame();
+      if (frame == nullptr) {
+        return Respond(blinky::PixelStatus::kNoFrame);
+      }
+      const size_t pixel_count = host_->layout().pixel_count();
+      if (request.first_pixel > pixel_count ||
+          request.pixel_count > pixel_count - request.first_pixel) {
+        return Respond(blinky::PixelStatus::kOutOfRange);
+      }
+      const size_t bytes = size_t{request.pixel_count} * blinky::kPixelBytes;
+      GBytes* response = Respond(blinky::PixelStatus::kOk,
+                                 request.pixel_count, bytes, &payload);
+      std::memcpy(payload, frame->pixels + request.first_pixel, bytes);
+      return response;
+    }
+    case blinky::PixelMessageType::kGetStats: {
+      GBytes* response = Respond(blinky::PixelStatus::kOk, 0,
+                                 blinky::kPixelStatsSize, &payload);
+      blinky::EncodePixelStats(host_->stats(), payload);
+      return response;
+    }
+    case blinky::PixelMessageType::kSetPixels: {
+      const bool in_range = host_->SetZonePixels(
+          request.first_pixel, request.pixel_count, request.pixels);
+      return Respond(in_range ? blinky::PixelStatus::kOk
+                              : blinky::PixelStatus::kOutOfRange);
+    }
+  }
+  return Respond(blinky::PixelStatus::kBadRequest);
+}
+
+GBytes* PixelChannel::Respond(blinky::PixelStatus status,
+                              uint32_t pixel_count, size_t payload_size,
+                              uint8_t** payload) {
+  const blinky::Frame* frame = host_->latest_frame();
+  blinky::PixelResponseHeader header;
+  header.status = status;
+  header.width = host_->layout().width;
+  header.height = host_->layout().height;
+  header.frame_index = frame != nullptr ? frame->index : 0;
+  header.pixel_count = pixel_count;
+
+  uint8_t* data = nullptr;
+  GBytes* response =
+      pool_.Acquire(blinky::kPixelResponseHeaderSize + payload_size, &data);
+  blinky::EncodePixelResponseHeader(header, data);
+  if (payload != nullptr) *payload = data + blinky::kPixelResponseHeaderSize;
+  return response;
+}
+
+// static
+void PixelChannel::OnMessage(FlBinaryMessenger* messenger,
+                             const gchar* channel, GBytes* message,
+                             FlBinaryMessengerResponseHandle* response_handle,
+                             gpointer user_data) {
+  PixelChannel* self = static_cast<PixelChannel*>(user_data);
+  g_autoptr(GBytes) response = self->HandleMessage(message);
+  g_autoptr(GError) error = nullptr;
+  if (!fl_binary_messenger_send_response(messenger, response_handle, response,
+                                         &error)) {
+    g_warning("Failed to send pixel channel response: %s", error->message);
+  }
+}
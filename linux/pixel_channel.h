@@ -0,0 +1,84 @@
+#ifndef RUNNER_PIXEL_CHANNEL_H_
+#define RUNNER_PIXEL_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "engine/pixel_protocol.h"
+#include "lighting_host.h"
+
+// Recycles the memory behind response GBytes.
+//
+// Each GBytes wraps a pooled buffer and hands it back when Flutter drops
+// its last reference, so steady-state responses allocate no payload
+// memory. Buffers may come back on any thread, and after the pool's owner
+// is gone.
+class GBytesPool {
+ public:
+  GBytesPool();
+
+  // Returns a GBytes of |size| bytes whose memory is writable through
+  // |*data| until the GBytes is first handed out.
+  GBytes* Acquire(size_t size, uint8_t** data);
+
+ private:
+  struct Buffer;
+  struct State;
+
+  static void Return(gpointer buffer);
+
+  std::shared_ptr<State> state_;
+};
+
+// Serves the packed pixel protocol (engine/pixel_protocol.h) on the
+// "blinky/pixels" channel.
+//
+// The handler sits directly on the FlBinaryMessenger instead of going
+// through FlBasicMessageChannel: FlBinaryCodec boxes every message into an
+// FlValue uint8 list, adding a copy each way. Messages are still plain
+// bytes, so the Dart side talks to it with
+// BasicMessageChannel<ByteData?>('blinky/pixels', BinaryCodec()).
+class PixelChannel {
+ public:
+  static constexpr char kChannelName[] = "blinky/pixels";
+
+  // With a nonzero |frame_interval_ms|, a frame request renders a new frame
+  // first if the host's latest one is at least that old, so the preview
+  // renders only while the app polls it. |messenger| may be null to drive
+  // HandleMessage() and the host directly, as the benchmark does. |host|
+  // must outlive the channel.
+  PixelChannel(FlBinaryMessenger* messenger, LightingHost* host,
+               guint frame_interval_ms = 0);
+  ~PixelChannel();
+
+  PixelChannel(const PixelChannel&) = delete;
+  PixelChannel& operator=(const PixelChannel&) = delete;
+
+  // Answers one request. Pixel payloads are copied once: uploads straight
+  // from |message| into the host, frames straight from the engine's frame
+  // buffer into the response.
+  GBytes* HandleMessage(GBytes* message);
+
+ private:
+  static void OnMessage(FlBinaryMessenger* messenger, const gchar* channel,
+                        GBytes* message,
+                        FlBinaryMessengerResponseHandle* response_handle,
+                        gpointer user_data);
+
+  // Returns a response with room for |payload_size| bytes after the header,
+  // pointing |*payload| at them.
+  GBytes* Respond(blinky::PixelStatus status, uint32_t pixel_count = 0,
+                  size_t payload_size = 0, uint8_t** payload = nullptr);
+
+  FlBinaryMessenger* messenger_;
+  LightingHost* host_;
+  guint frame_interval_ms_;
+  GBytesPool pool_;
+};
+
+#endif  // RUNNER_PIXEL_CHANNEL_H_
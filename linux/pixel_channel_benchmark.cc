@@ -0,0 +1,162 @@
+// Compares the native side of three ways to move pixels over a platform
+// channel, at 10k and 100k pixels:
+//
+//   method    FlStandardMethodCodec with one FlValue int per pixel, the way
+//             a MethodChannel would carry a List<int> of ARGB colors. Every
+//             pixel is boxed (or unboxed) and encoded separately.
+//   basic     FlBasicMessageChannel's FlBinaryCodec: one FlValue uint8 list.
+//             Two payload copies each way: into the FlValue and then into
+//             the GBytes for a frame, into the FlValue and then into the
+//             host for an upload.
+//   packed    PixelChannel's packed protocol on pooled GBytes. One copy each
+//             way: frame buffer to response, message to host.
+//
+// "frame" encodes a full frame for Dart; "upload" decodes a full frame of
+// zone colors from Dart and stores it in the host. Configure the runner
+// with -DBLINKY_BUILD_BENCHMARKS=ON and run build/.../pixel_channel_benchmark.
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "engine/pixel_protocol.h"
+#include "lighting_host.h"
+#include "pixel_channel.h"
+
+namespace {
+
+constexpr int kIterations = 50;
+
+uint32_t ToArgb(blinky::Rgba8 pixel) {
+  return uint32_t{pixel.a} << 24 | uint32_t{pixel.r} << 16 |
+         uint32_t{pixel.g} << 8 | pixel.b;
+}
+
+blinky::Rgba8 FromArgb(int64_t argb) {
+  return blinky::Rgba8{static_cast<uint8_t>(argb >> 16),
+                       static_cast<uint8_t>(argb >> 8),
+                       static_cast<uint8_t>(argb),
+                       static_cast<uint8_t>(argb >> 24)};
+}
+
+// Average microseconds per call of |body| over kIterations runs.
+template <typename Body>
+double TimeMicros(Body body) {
+  body();  // Warm up caches and the buffer pool.
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; ++i) body();
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kIterations;
+}
+
+void Report(const char* path, const char* direction, size_t pixels,
+            double micros) {
+  std::printf("%-8s %-8s %8zu px %10.1f us %8.2f ns/px\n", path, direction,
+              pixels, micros, micros * 1000.0 / pixels);
+}
+
+void RunMethodChannel(LightingHost* host) {
+  const size_t pixel_count = host->layout().pixel_count();
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  FlMethodCodecClass* codec_class = FL_METHOD_CODEC_GET_CLASS(codec);
+
+  Report("method", "frame", pixel_count, TimeMicros([&] {
+           const blinky::Frame* frame = host->latest_frame();
+           g_autoptr(FlValue) list = fl_value_new_list();
+           for (size_t i = 0; i < pixel_count; ++i) {
+             fl_value_append_take(list,
+                                  fl_value_new_int(ToArgb(frame->pixels[i])));
+           }
+           g_autoptr(GBytes) message = codec_class->encode_success_envelope(
+               FL_METHOD_CODEC(codec), list, nullptr);
+         }));
+
+  g_autoptr(FlValue) upload = fl_value_new_list();
+  for (size_t i = 0; i < pixel_count; ++i) {
+    fl_value_append_take(upload, fl_value_new_int(0x80402010));
+  }
+  g_autoptr(GBytes) call = codec_class->encode_method_call(
+      FL_METHOD_CODEC(codec), "setPixels", upload, nullptr);
+  std::vector<blinky::Rgba8> unboxed(pixel_count);
+  Report("method", "upload", pixel_count, TimeMicros([&] {
+           g_autofree gchar* name = nullptr;
+           g_autoptr(FlValue) args = nullptr;
+           codec_class->decode_method_call(FL_METHOD_CODEC(codec), call, &name,
+                                           &args, nullptr);
+           for (size_t i = 0; i < pixel_count; ++i) {
+             unboxed[i] = FromArgb(
+                 fl_value_get_int(fl_value_get_list_value(args, i)));
+           }
+           host->SetZonePixels(0, pixel_count,
+                               reinterpret_cast<uint8_t*>(unboxed.data()));
+         }));
+}
+
+void RunBasicChannel(LightingHost* host) {
+  const size_t pixel_count = host->layout().pixel_count();
+  const size_t bytes = pixel_count * blinky::kPixelBytes;
+  g_autoptr(FlBinaryCodec) codec = fl_binary_codec_new();
+
+  Report("basic", "frame", pixel_count, TimeMicros([&] {
+           const blinky::Frame* frame = host->latest_frame();
+           g_autoptr(FlValue) value = fl_value_new_uint8_list(
+               reinterpret_cast<const uint8_t*>(frame->pixels), bytes);
+           g_autoptr(GBytes) message = fl_message_codec_encode_message(
+               FL_MESSAGE_CODEC(codec), value, nullptr);
+         }));
+
+  std::vector<uint8_t> upload(bytes, 0x40);
+  g_autoptr(GBytes) message = g_bytes_new(upload.data(), upload.size());
+  Report("basic", "upload", pixel_count, TimeMicros([&] {
+           g_autoptr(FlValue) value = fl_message_codec_decode_message(
+               FL_MESSAGE_CODEC(codec), message, nullptr);
+           host->SetZonePixels(0, pixel_count,
+                               fl_value_get_uint8_list(value));
+         }));
+}
+
+void RunPackedChannel(LightingHost* host) {
+  const size_t pixel_count = host->layout().pixel_count();
+  PixelChannel channel(nullptr, host);
+
+  blinky::PixelRequest frame_request;
+  frame_request.type = blinky::PixelMessageType::kGetFrame;
+  frame_request.pixel_count = static_cast<uint32_t>(pixel_count);
+  std::vector<uint8_t> frame_bytes(blinky::PixelRequestSize(frame_request));
+  blinky::EncodePixelRequest(frame_request, frame_bytes.data());
+  g_autoptr(GBytes) frame_message =
+      g_bytes_new(frame_bytes.data(), frame_bytes.size());
+  Report("packed", "frame", pixel_count, TimeMicros([&] {
+           g_autoptr(GBytes) response = channel.HandleMessage(frame_message);
+         }));
+
+  std::vector<uint8_t> pixels(pixel_count * blinky::kPixelBytes, 0x40);
+  blinky::PixelRequest upload_request;
+  upload_request.type = blinky::PixelMessageType::kSetPixels;
+  upload_request.pixel_count = static_cast<uint32_t>(pixel_count);
+  upload_request.pixels = pixels.data();
+  std::vector<uint8_t> upload_bytes(blinky::PixelRequestSize(upload_request));
+  blinky::EncodePixelRequest(upload_request, upload_bytes.data());
+  g_autoptr(GBytes) upload_message =
+      g_bytes_new(upload_bytes.data(), upload_bytes.size());
+  Report("packed", "upload", pixel_count, TimeMicros([&] {
+           g_autoptr(GBytes) response = channel.HandleMessage(upload_message);
+         }));
+}
+
+}  // namespace
+
+int main() {
+  const blinky::Layout kLayouts[] = {{100, 100}, {400, 250}};
+  for (const blinky::Layout& layout : kLayouts) {
+    LightingHost host(layout);
+    host.Tick();
+    RunMethodChannel(&host);
+    RunBasicChannel(&host);
+    RunPackedChannel(&host);
+  }
+  return 0;
+}